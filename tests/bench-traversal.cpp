@@ -0,0 +1,126 @@
+// traversal benchmark:  virtual calls over a random-order heterogeneous std::vector<value_ptr<Base>>
+//	build optimized, e.g.  g++ -std=c++11 -O2 -I. tests/bench-traversal.cpp -o bench.t && ./bench.t [elements]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../value_ptr.hpp"
+#include "../value_ptr_traversal.hpp"
+
+namespace {
+	using namespace smart_ptr;
+
+	struct Shape {
+		virtual ~Shape() = default;
+		virtual Shape* clone() const = 0;
+		virtual long area() const = 0;
+	};
+
+	// differing sizes so pointees of each type land in different size classes
+	template <int N>
+	struct Poly : Shape {
+		long data[N * 2];
+		explicit Poly( long seed ) { for ( auto& d : data ) d = seed; }
+		Poly* clone() const override { return new Poly( *this ); }
+		long area() const override { return data[0] * N + N; }
+	};
+
+	// element built from the concrete pointer, so value_ptr_tagged binds the dynamic type rather than abstract Shape
+	template <typename P>
+	P make_element( Shape* ptr, unsigned kind ) {
+		switch ( kind ) {
+		case 0: return P( static_cast<Poly<1>*>( ptr ) );
+		case 1: return P( static_cast<Poly<2>*>( ptr ) );
+		case 2: return P( static_cast<Poly<3>*>( ptr ) );
+		default: return P( static_cast<Poly<4>*>( ptr ) );
+		}
+	}
+
+	template <typename P>
+	std::vector<P> make_shapes( std::size_t n, unsigned seed ) {
+		std::mt19937 rng( seed );
+		std::vector<std::pair<Shape*, unsigned>> raw;
+		raw.reserve( n );
+		for ( std::size_t i = 0; i < n; ++i ) {
+			const long v = static_cast<long>( rng() % 100 );
+			const unsigned kind = rng() % 4;
+			switch ( kind ) {
+			case 0: raw.emplace_back( new Poly<1>( v ), kind ); break;
+			case 1: raw.emplace_back( new Poly<2>( v ), kind ); break;
+			case 2: raw.emplace_back( new Poly<3>( v ), kind ); break;
+			default: raw.emplace_back( new Poly<4>( v ), kind ); break;
+			}
+		}
+		std::shuffle( raw.begin(), raw.end(), rng );	// traversal order unrelated to allocation order
+
+		std::vector<P> result;
+		result.reserve( n );
+		for ( const auto& r : raw )
+			result.push_back( make_element<P>( r.first, r.second ) );
+		return result;
+	}
+
+	template <typename F>
+	double ns_per_element( std::size_t n, int reps, F&& f ) {
+		double best = 1e300;
+		for ( int r = 0; r < reps; ++r ) {
+			const auto start = std::chrono::steady_clock::now();
+			f();
+			const auto stop = std::chrono::steady_clock::now();
+			const double ns = std::chrono::duration<double, std::nano>( stop - start ).count() / static_cast<double>( n );
+			best = ns < best ? ns : best;
+		}
+		return best;
+	}
+
+	volatile long sink;
+
+	template <typename P>
+	void run( const char* name, std::size_t n ) {
+		const auto shapes = make_shapes<P>( n, 42 );
+		const int reps = 5;
+
+		const double plain = ns_per_element( n, reps, [&]() {
+			long total = 0;
+			for ( const auto& p : shapes )
+				total += p->area();
+			sink = total;
+		} );
+
+		double prefetch[3];
+		const std::size_t distances[3] = { 4, 8, 16 };
+		for ( int d = 0; d < 3; ++d ) {
+			prefetch[d] = ns_per_element( n, reps, [&]() {
+				long total = 0;
+				for ( const auto& p : prefetched( shapes, distances[d] ) )
+					total += p->area();
+				sink = total;
+			} );
+		}
+
+		std::vector<Shape*> sorted;
+		const double sort = ns_per_element( n, reps, [&]() { sorted = by_dynamic_type( shapes ); } );
+		const double visit_sorted = ns_per_element( n, reps, [&]() {
+			long total = 0;
+			for ( auto p : sorted )
+				total += p->area();
+			sink = total;
+		} );
+
+		std::printf( "%-22s n=%-9zu plain %6.2f | prefetched d=4 %6.2f d=8 %6.2f d=16 %6.2f | by_dynamic_type build %6.2f visit %6.2f  (ns/element)\n"
+			, name, n, plain, prefetch[0], prefetch[1], prefetch[2], sort, visit_sorted );
+	}
+}
+
+int main( int argc, char** argv ) {
+	const std::size_t n = argc > 1 ? static_cast<std::size_t>( std::strtoull( argv[1], nullptr, 10 ) ) : ( std::size_t( 1 ) << 20 );
+	run<value_ptr<Shape>>( "value_ptr", n / 64 );	// cache resident
+	run<value_ptr<Shape>>( "value_ptr", n );
+	run<value_ptr_tagged<Shape>>( "value_ptr_tagged", n );
+	return 0;
+}
@@ -1,5 +1,11 @@
 #include <cassert>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #ifdef _DEBUG
 #ifdef _WIN32
@@ -12,8 +18,22 @@
 
 #include "../value_ptr.hpp"
 #include "../value_ptr_incomplete.hpp"
+#include "../value_ptr_shared_policy.hpp"
+#include "../value_ptr_pool.hpp"
+#include "../value_ptr_graph.hpp"
+#include "../value_ptr_hashed.hpp"
+#include "../value_ptr_interned.hpp"
+#include "../value_ptr_lazy.hpp"
+#include "../value_ptr_cow.hpp"
+#include "../value_ptr_indirect.hpp"
+#include "../value_ptr_erased.hpp"
+#include "../value_ptr_traversal.hpp"
+#include "../value_ptr_any.hpp"
+#include "../value_ptr_versioned.hpp"
+#include "../value_ptr_batch.hpp"
 #include "test-pimpl.hpp"
 #include "test-incomplete.hpp"
+#include "test-audit.hpp"
 
 namespace {
 	using namespace smart_ptr;
@@ -302,6 +322,38 @@ void incomplete_tests() {
 		assert( w3.is_clone_derived() );	// state should have been carried over from w2
 	}
 
+	// fast pimpl example using test-pimpl; impl stored inline
+	{
+		static_assert( sizeof( fast_widget ) == 3 * sizeof( void* ), "fast pimpl size check fail" );
+		{
+			fast_widget w{};
+			assert( w.pImpl );
+			assert( w.get_meaning_of_life() == 42 );
+			assert( fast_widget::live_impls() == 1 );
+
+			auto w2 = w;	// copy incomplete
+			w2.set_meaning_of_life( 7 );
+			assert( w.get_meaning_of_life() == 42 );
+			assert( w2.get_meaning_of_life() == 7 );
+			assert( fast_widget::live_impls() == 2 );
+
+			auto w3 = std::move( w2 );	// move incomplete
+			assert( !w2.pImpl );
+			assert( w3.get_meaning_of_life() == 7 );
+			assert( fast_widget::live_impls() == 2 );
+
+			swap( w.pImpl, w3.pImpl );
+			assert( w.get_meaning_of_life() == 7 );
+			assert( w3.get_meaning_of_life() == 42 );
+
+			w = w3;	// copy assign
+			assert( w.get_meaning_of_life() == 42 );
+			w3.pImpl = nullptr;
+			assert( fast_widget::live_impls() == 1 );
+		}
+		assert( fast_widget::live_impls() == 0 );
+	}
+
 }	// incomplete
 
 void deleter_tests() {
@@ -494,6 +546,1274 @@ void unique_ptr_tests() {
 
 }
 
+// stateful allocator for shared policy tests; counts live allocations
+template <typename T>
+struct CountingAllocator {
+	using value_type = T;
+	int* live;
+
+	CountingAllocator( int* live_ ) : live( live_ ) {}
+	template <typename U> CountingAllocator( const CountingAllocator<U>& that ) : live( that.live ) {}
+
+	T* allocate( std::size_t n ) { ++*this->live; return std::allocator<T>().allocate( n ); }
+	void deallocate( T* ptr, std::size_t n ) { --*this->live; std::allocator<T>().deallocate( ptr, n ); }
+};	// CountingAllocator
+
+template <typename T, typename U> bool operator==( const CountingAllocator<T>& x, const CountingAllocator<U>& y ) { return x.live == y.live; }
+template <typename T, typename U> bool operator!=( const CountingAllocator<T>& x, const CountingAllocator<U>& y ) { return !( x == y ); }
+
+void shared_policy_tests() {
+
+	static_assert( sizeof( value_ptr_shared_policy<A> ) == sizeof( A* ), "Size check fail" );
+
+	int live = 0;
+	{
+		shared_policy policy{ CountingAllocator<char>( &live ) };
+		assert( policy.use_count() == 1 );
+
+		auto a = make_value_shared<A>( policy, 5 );
+		assert( a->foo == 5 );
+		assert( live == 1 );
+		assert( policy.use_count() == 2 );	// policy handle + pointee
+
+		auto b = a;	// copy allocates through the shared policy
+		assert( b->foo == 5 );
+		assert( b.get() != a.get() );
+		assert( live == 2 );
+		assert( policy.use_count() == 3 );
+
+		a.reset();
+		assert( live == 1 );
+		assert( policy.use_count() == 2 );
+
+		value_ptr_shared_policy<A> c{};
+		auto d = c;	// copy of null
+		assert( !d );
+	}
+	assert( live == 0 );	// pointees and control block released
+
+	{	// pointees keep the control block alive after the policy handle is gone
+		value_ptr_shared_policy<A> a{};
+		{
+			shared_policy policy{ CountingAllocator<char>( &live ) };
+			a = make_value_shared<A>( policy, 9 );
+		}
+		auto b = a;
+		assert( b->foo == 9 );
+		assert( live == 2 );
+	}
+	assert( live == 0 );
+}
+
+void pool_tests() {
+
+	static_assert( sizeof( value_ptr_pooled<A> ) == sizeof( A* ), "Size check fail" );
+
+	// struct local to this test so the thread-local pools start empty
+	struct Msg { int foo; Msg( int foo_ ) : foo( foo_ ) {} };
+
+	{
+		auto a = make_value_pooled<Msg>( 5 );
+		assert( a->foo == 5 );
+		assert( value_pool<Msg>::stats().misses == 1 );
+
+		auto b = a;	// copy from the pool
+		assert( b->foo == 5 );
+		assert( value_pool<Msg>::stats().misses == 2 );
+
+		b.reset();	// slot returned to the free list
+		assert( value_pool<Msg>::stats().cached == 1 );
+		assert( value_pool<Msg>::stats().local_frees == 1 );
+
+		auto c = a;	// copy reuses the cached slot
+		assert( c->foo == 5 );
+		assert( value_pool<Msg>::stats().hits == 1 );
+		assert( value_pool<Msg>::stats().cached == 0 );
+
+		value_ptr_pooled<Msg> d{};
+		auto e = d;	// copy of null
+		assert( !e );
+	}
+
+	// polymorphic, no clone() member required; pools are per dynamic type
+	{
+		struct Base {
+			int foo;
+			Base( int foo_ ) : foo( foo_ ) {}
+			virtual int value() const { return foo; }
+			virtual ~Base() = default;
+		};
+		struct Derived : Base {
+			int bar;
+			Derived( int foo_, int bar_ ) : Base( foo_ ), bar( bar_ ) {}
+			int value() const override { return foo + bar; }
+		};
+
+		value_ptr_pooled<Base> a = make_value_pooled<Base, Derived>( 1, 2 );
+		auto b = a;	// copy preserves dynamic type
+		assert( b->value() == 3 );
+		assert( value_pool<Derived>::stats().misses == 2 );
+		assert( value_pool<Base>::stats().misses == 0 );
+	}
+
+	// cross-thread free is sent back to the owning pool
+	{
+		auto a = make_value_pooled<Msg>( 7 );
+		std::thread( [&a]() {
+			auto b = a;	// copy allocates from this thread's pool
+			assert( b->foo == 7 );
+			a.reset();	// free sent back to the main thread's pool
+		} ).join();
+		assert( !a );
+		assert( value_pool<Msg>::stats().remote_frees == 1 );
+
+		const auto hits = value_pool<Msg>::stats().hits;
+		auto c = make_value_pooled<Msg>( 9 );	// reclaims the remote slot
+		assert( value_pool<Msg>::stats().hits == hits + 1 );
+		assert( c->foo == 9 );
+	}
+
+	// objects outliving their owning thread
+	{
+		value_ptr_pooled<Msg> a{};
+		std::thread( [&a]() { a = make_value_pooled<Msg>( 11 ); } ).join();
+		auto b = a;
+		assert( b->foo == 11 );
+	}
+}
+
+void graph_tests() {
+
+	struct Leaf { int foo; };
+
+	// observers remapped into the cloned graph, including forward references
+	struct Tree {
+		Leaf* before;	// observes right, which is copied later
+		value_ptr_graph<Leaf> left, right;
+		Leaf* after;	// observes left, which has already been copied
+		const Leaf* outside;	// observes an object outside the graph
+
+		Tree( int l, int r, const Leaf* outside_ )
+			: before( nullptr ), left( new Leaf{ l } ), right( new Leaf{ r } ), after( nullptr ), outside( outside_ )
+		{
+			this->before = this->right.get();
+			this->after = this->left.get();
+		}
+
+		Tree( const Tree& that )
+			: before( nullptr ), left( that.left ), right( that.right ), after( nullptr ), outside( nullptr )
+		{
+			if ( auto ctx = clone_context::current() ) {
+				ctx->remap( this->before, that.before );
+				ctx->remap( this->after, that.after );
+				ctx->remap( this->outside, that.outside );
+			}
+		}
+	};	// Tree
+
+	{
+		const Leaf external{ 99 };
+		value_ptr_graph<Tree> a{ new Tree( 1, 2, &external ) };
+		auto b = clone_graph( a );
+		assert( b.get() != a.get() );
+		assert( b->left.get() != a->left.get() );
+		assert( b->after == b->left.get() );
+		assert( b->before == b->right.get() );
+		assert( b->outside == &external );
+
+		auto c = a;	// plain copy outside clone_graph still deep copies
+		assert( c->left->foo == 1 );
+	}
+
+	// observers typed as a non-primary base of a polymorphic pointee
+	{
+		struct L0 { virtual ~L0() = default; int a = 0; };
+		struct L1 { virtual ~L1() = default; int b = 0; };
+		struct Multi : L0, L1 {};
+		struct Holder {
+			value_ptr_graph<Multi> leaf;
+			L1* observer;
+
+			Holder() : leaf( new Multi() ), observer( this->leaf.get() ) {}
+			Holder( const Holder& that ) : leaf( that.leaf ), observer( nullptr ) {
+				clone_context::current()->remap( this->observer, that.observer );
+			}
+		};
+		Holder a;
+		assert( static_cast<void*>( a.observer ) != static_cast<void*>( a.leaf.get() ) );	// not the primary base
+		auto b = clone_graph( a );
+		assert( b.observer == static_cast<L1*>( b.leaf.get() ) );
+	}
+
+	// shared sub-objects cloned exactly once
+	{
+		static int copies = 0;
+		struct Shared {
+			int foo;
+			Shared( int foo_ ) : foo( foo_ ) {}
+			Shared( const Shared& that ) : foo( that.foo ) { ++copies; }
+		};
+		struct Holder {
+			std::shared_ptr<Shared> x, y;
+			Holder( std::shared_ptr<Shared> x_, std::shared_ptr<Shared> y_ ) : x( x_ ), y( y_ ) {}
+			Holder( const Holder& that )
+				: x( clone_context::current()->clone_shared( that.x ) )
+				, y( clone_context::current()->clone_shared( that.y ) )
+			{}
+		};
+		auto s = std::make_shared<Shared>( 5 );
+		value_ptr_graph<Holder> a{ new Holder( s, s ) };
+		auto b = clone_graph( a );
+		assert( copies == 1 );
+		assert( b->x == b->y );
+		assert( b->x != a->x );
+		assert( b->x->foo == 5 );
+	}
+
+	// clone(clone_context&) hook
+	{
+		struct Node {
+			int foo;
+			Node* self;
+			Node( int foo_ ) : foo( foo_ ), self( this ) {}
+			Node* clone( clone_context& ctx ) const {
+				auto result = new Node( this->foo );
+				ctx.record( this, result );
+				result->self = ctx.remap( this->self );
+				return result;
+			}
+		};
+		value_ptr_graph<Node> a{ new Node( 3 ) };
+		auto b = clone_graph( a );
+		assert( b->self == b.get() );
+		assert( b->foo == 3 );
+	}
+
+	// large graph; map growth
+	{
+		struct Chain {
+			std::vector<value_ptr_graph<Leaf>> leaves;
+			std::vector<Leaf*> observers;
+
+			Chain() = default;
+			Chain( const Chain& that ) : leaves( that.leaves ), observers( that.observers.size() ) {
+				// observers pre-sized:  deferred remaps write through the slot address, which must not move before clone_graph returns
+				for ( std::size_t i = 0; i < that.observers.size(); ++i )
+					clone_context::current()->remap( this->observers[i], that.observers[i] );
+			}
+		};
+		Chain a;
+		for ( int i = 0; i < 1000; ++i ) {
+			a.leaves.emplace_back( new Leaf{ i } );
+			a.observers.push_back( a.leaves[( i * 7 ) % ( i + 1 )].get() );
+		}
+		auto b = clone_graph( a );
+		for ( int i = 0; i < 1000; ++i )
+			assert( b.observers[i] == b.leaves[( i * 7 ) % ( i + 1 )].get() );
+	}
+}
+
+void hash_tests() {
+
+	// deep comparators, std::hash of pointee
+	{
+		auto a = make_value<std::string>( "foo" );
+		auto b = make_value<std::string>( "foo" );
+		value_ptr<std::string> n1{}, n2{};
+		assert( a != b );	// address compare
+		assert( deep_equal()( a, b ) );
+		assert( deep_equal()( n1, n2 ) );
+		assert( !deep_equal()( a, n1 ) );
+		assert( deep_less()( n1, a ) );
+		assert( !deep_less()( a, n1 ) );
+		assert( !deep_less()( a, b ) );
+		assert( std::hash<value_ptr<std::string>>()( a ) == std::hash<std::string>()( "foo" ) );
+		assert( std::hash<value_ptr<std::string>>()( n1 ) == 0 );
+
+		std::unordered_set<value_ptr<std::string>, deep_hash, deep_equal> set;
+		set.insert( a );
+		assert( set.count( b ) == 1 );
+		assert( set.count( make_value<std::string>( "bar" ) ) == 0 );
+
+		std::set<value_ptr<std::string>, deep_less> ordered;
+		ordered.insert( make_value<std::string>( "b" ) );
+		ordered.insert( make_value<std::string>( "a" ) );
+		assert( **ordered.begin() == "a" );
+	}
+
+	// cached hash
+	{
+		value_ptr_hashed<std::string> a{ new std::string( "foo" ) };
+		value_ptr_hashed<std::string> b = make_value<std::string>( "foo" );
+		const auto& ca = a;
+		assert( a == b );	// value compare
+		assert( ca.hash() == b.hash() );
+		assert( *ca == "foo" );	// const access keeps the hash
+
+		*a = "bar";	// non-const access invalidates
+		assert( a != b );
+		const auto h = std::hash<std::string>()( "bar" );
+		assert( a.hash() == ( h ? h : 1 ) );	// 0 maps to 1
+
+		auto c = a;	// copy keeps value and hash
+		assert( c == a );
+		assert( c.get() != a.get() );
+
+		value_ptr_hashed<std::string> n{};
+		assert( n.hash() != 0 );	// 0 is reserved
+		assert( n == value_ptr_hashed<std::string>() );
+		assert( n < a );
+
+		std::unordered_set<value_ptr_hashed<std::string>> set;
+		set.insert( b );
+		set.insert( value_ptr_hashed<std::string>( new std::string( "foo" ) ) );
+		assert( set.size() == 1 );
+		assert( set.count( a ) == 0 );
+	}
+}
+
+void interned_tests() {
+
+	using interned_string = interned_value_ptr<std::string>;
+	{
+		interned_string a{ std::string( "config" ) };
+		auto b = make_interned<std::string>( "config" );
+		auto c = make_interned<std::string>( "other" );
+		assert( a == b );	// equal values share one instance
+		assert( a.get() == b.get() );
+		assert( a != c );
+		assert( *a == "config" );
+		assert( a.use_count() == 2 );
+		assert( interned_string::interned_count() == 2 );
+
+		auto d = a;	// copy shares the instance
+		assert( d == a );
+		assert( a.use_count() == 3 );
+
+		auto e = interned_string( make_value<std::string>( "config" ) );	// intern from value_ptr
+		assert( e == a );
+
+		auto f = a.to_value_ptr();	// independent mutable copy
+		*f += "!";
+		assert( *a == "config" );
+
+		c.reset();	// last reference evicts the entry
+		assert( !c );
+		assert( interned_string::interned_count() == 1 );
+
+		interned_string n{};
+		assert( !n );
+		assert( std::hash<interned_string>()( a ) == std::hash<std::string>()( "config" ) );
+	}
+	assert( interned_string::interned_count() == 0 );
+
+	// concurrent interning of the same values
+	{
+		std::vector<interned_string> results( 8 * 100 );
+		std::vector<std::thread> threads;
+		for ( int t = 0; t < 8; ++t )
+			threads.emplace_back( [&results, t]() {
+				for ( int i = 0; i < 100; ++i ) {
+					results[t * 100 + i] = make_interned<std::string>( std::to_string( i % 10 ) );
+					interned_string temp = make_interned<std::string>( std::to_string( i % 10 ) );	// acquire/release churn
+				}
+			} );
+		for ( auto& t : threads )
+			t.join();
+		for ( int t = 0; t < 8; ++t )
+			for ( int i = 0; i < 100; ++i )
+				assert( results[t * 100 + i] == results[i % 10] );
+		assert( interned_string::interned_count() == 10 );
+	}
+	assert( interned_string::interned_count() == 0 );
+}
+
+void lazy_tests() {
+
+	{
+		int built = 0;
+		lazy_value_ptr<A> a{ [&built]() { ++built; return make_value<A>( 5 ); } };
+		assert( !a.is_materialized() );
+
+		auto b = a;	// copy of unmaterialized copies the factory only
+		assert( built == 0 );
+		assert( !b.is_materialized() );
+
+		assert( a->foo == 5 );	// first access builds
+		assert( a.is_materialized() );
+		assert( built == 1 );
+		assert( a->foo == 5 );
+		assert( built == 1 );
+
+		auto c = a;	// copy of materialized is a deep copy
+		assert( c.is_materialized() );
+		assert( c.get() != a.get() );
+		assert( c->foo == 5 );
+		assert( built == 1 );
+
+		assert( b );	// b builds independently
+		assert( built == 2 );
+
+		auto d = std::move( b );
+		assert( d->foo == 5 );
+
+		a.reset();
+		assert( !a );
+
+		lazy_value_ptr<A> e{};
+		assert( e.is_materialized() );
+		assert( !e );
+	}
+
+	// make_lazy_value, materialized copies use the copier
+	{
+		auto a = make_lazy_value<A>( 21 );
+		assert( !a.is_materialized() );
+		assert( ( *a ).foo == 21 );
+
+		copier_called = false;
+		lazy_value_ptr<A, std::default_delete<A>, MyCopierTest> b{ value_ptr<A, std::default_delete<A>, MyCopierTest>( new A{ 3 }, {}, { 7 } ) };
+		assert( b.is_materialized() );
+		auto c = b;
+		assert( copier_called );
+		assert( c.get_copier().baz == 7 );
+	}
+
+	// thread-safe once initialization
+	{
+		std::atomic<int> built{ 0 };
+		lazy_value_ptr_synchronized<A> a{ [&built]() { ++built; return make_value<A>( 9 ); } };
+		std::vector<std::thread> threads;
+		for ( int t = 0; t < 8; ++t )
+			threads.emplace_back( [&a]() { assert( a->foo == 9 ); } );
+		for ( auto& t : threads )
+			t.join();
+		assert( built == 1 );
+
+		auto b = a;
+		assert( b->foo == 9 );
+		assert( built == 1 );
+	}
+}
+
+void cow_tests() {
+
+	static_assert( sizeof( value_ptr_cow<A> ) == sizeof( A* ), "Size check fail" );
+
+	struct Big { int data[64 * 1024]; };	// 256KB, above the 4KB threshold used here
+	{
+		auto a = make_value_cow<Big, 4096>();
+		assert( a->data[0] == 0 );
+		a->data[0] = 1;
+		a->data[20000] = 2;
+
+		auto b = a;	// copy shares unmodified pages
+		assert( b.get() != a.get() );
+		assert( b->data[0] == 1 );
+		assert( b->data[20000] == 2 );
+		assert( b->data[40000] == 0 );
+
+		b->data[0] = 3;	// writes are private to each copy
+		a->data[40000] = 4;
+		assert( a->data[0] == 1 );
+		assert( b->data[40000] == 0 );
+
+		auto c = b;	// copy of a copy
+		assert( c->data[0] == 3 );
+		assert( c->data[20000] == 2 );
+		assert( c->data[40000] == 0 );
+
+		a.reset();	// mapping of b, c still valid after the original is gone
+		auto d = c;
+		assert( d->data[0] == 3 );
+
+		value_ptr_cow<Big, 4096> e{};
+		auto f = e;	// copy of null
+		assert( !f );
+	}
+
+#if defined( __linux__ )
+	// unwritten pages of a copy stay backed by the shared file, written pages become private
+	{
+		const std::size_t page = detail::cow_page_size();
+		auto file_backed = []( const void* ptr, std::size_t page_size ) {
+			std::uint64_t entry = 0;
+			const off_t at = static_cast<off_t>( reinterpret_cast<std::uintptr_t>( ptr ) / page_size * sizeof( entry ) );
+			const auto bytes = ::pread( detail::cow_pagemap(), &entry, sizeof( entry ), at );
+			assert( bytes == static_cast<ssize_t>( sizeof( entry ) ) );
+			(void)bytes;
+			return ( ( entry >> 63 ) & 1 ) && ( ( entry >> 61 ) & 1 );	// present, file page
+		};
+
+		auto a = make_value_cow<Big, 4096>();
+		a->data[0] = 1;
+		auto b = a;
+		if ( detail::cow_pagemap() >= 0 ) {
+			const int* unwritten = &b->data[40000];
+			assert( *unwritten == 0 );	// fault the page in
+			assert( file_backed( unwritten, page ) );
+			b->data[40000] = 5;
+			assert( !file_backed( unwritten, page ) );
+		}
+	}
+
+	// throwing constructor releases the mapping and the file
+	{
+		struct Fragile {
+			int data[4096];
+			explicit Fragile( int ) { throw 1; }
+		};
+		auto mappings = []() {
+			std::ifstream maps( "/proc/self/maps" );
+			std::size_t n = 0;
+			for ( std::string line; std::getline( maps, line ); )
+				n += line.find( "value_ptr_cow" ) != std::string::npos ? 1 : 0;
+			return n;
+		};
+		const std::size_t before = mappings();
+		for ( int i = 0; i < 3; ++i ) {
+			bool thrown = false;
+			try {
+				make_value_cow<Fragile, 4096>( 1 );
+			}
+			catch ( int ) {
+				thrown = true;
+			}
+			assert( thrown );
+		}
+		assert( mappings() == before );
+	}
+#endif
+
+	// below threshold; default policies
+	{
+		auto a = make_value_cow<A>( 5 );
+		auto b = a;
+		assert( b->foo == 5 );
+		assert( b.get() != a.get() );
+	}
+}
+
+void indirect_tests() {
+
+	static_assert( sizeof( indirect<A> ) == sizeof( A* ), "Size check fail" );
+	static_assert( sizeof( polymorphic<A> ) == sizeof( A* ), "Size check fail" );
+
+	// indirect
+	{
+		indirect<A> a{};	// never null; value initialized
+		assert( !a.valueless_after_move() );
+		assert( a->foo == 0 );
+
+		auto b = make_indirect<A>( 5 );
+		auto c = b;	// deep copy
+		assert( c->foo == 5 );
+		assert( &*c != &*b );
+		c->foo = 6;
+		assert( b->foo == 5 );
+
+		const auto& cc = c;
+		static_assert( std::is_same<decltype( *cc ), const A&>::value, "const propagation fail" );
+
+		auto d = std::move( c );
+		assert( c.valueless_after_move() );
+		assert( d->foo == 6 );
+		c = b;	// assign to valueless
+		assert( c->foo == 5 );
+
+		swap( b, d );
+		assert( b->foo == 6 );
+		assert( d->foo == 5 );
+
+		// explicit conversions with value_ptr
+		auto v = static_cast<value_ptr<A>>( b );	// copy
+		assert( v->foo == 6 );
+		assert( v.get() != &*b );
+		auto w = static_cast<value_ptr<A>>( std::move( b ) );	// transfer
+		assert( b.valueless_after_move() );
+		assert( w->foo == 6 );
+		indirect<A> e{ std::move( w ) };
+		assert( !w );
+		assert( e->foo == 6 );
+	}
+
+	// polymorphic
+	{
+		struct Base {
+			int foo;
+			Base( int foo_ = 0 ) : foo( foo_ ) {}
+			virtual Base* clone() const { return new Base( *this ); }
+			virtual int value() const { return foo; }
+			virtual ~Base() = default;
+		};
+		struct Derived : Base {
+			int bar;
+			Derived( int foo_, int bar_ ) : Base( foo_ ), bar( bar_ ) {}
+			Base* clone() const override { return new Derived( *this ); }
+			int value() const override { return foo + bar; }
+		};
+
+		auto a = make_polymorphic<Base, Derived>( 1, 2 );
+		auto b = a;	// clone
+		assert( b->value() == 3 );
+		assert( &*b != &*a );
+
+		polymorphic<Base> c{ new Derived( 3, 4 ) };
+		c = b;
+		assert( c->value() == 3 );
+
+		auto v = static_cast<value_ptr<Base>>( c );
+		assert( v->value() == 3 );
+		polymorphic<Base> d{ std::move( v ) };
+		assert( d->value() == 3 );
+
+		auto e = std::move( d );
+		assert( d.valueless_after_move() );
+		assert( e->value() == 3 );
+	}
+
+	// custom copier kept on conversion to value_ptr; copies of the result do not slice
+	{
+		struct PB { virtual ~PB() = default; virtual int id() const { return 1; } };
+		struct PD : PB { int id() const override { return 2; } };
+		struct PCopier {
+			PB* operator()( const PB* what ) const { return new PD( static_cast<const PD&>( *what ) ); }
+		};
+		using holder = polymorphic<PB, std::default_delete<PB>, PCopier>;
+		static_assert( std::is_same<holder::value_ptr_type, value_ptr<PB, std::default_delete<PB>, detail::nullable_copy<PB, PCopier>>>::value, "conversion type check fail" );
+		static_assert( std::is_same<polymorphic<PB>::value_ptr_type, value_ptr<PB>>::value, "conversion type check fail" );
+
+		holder p{ new PD() };
+		auto v = static_cast<holder::value_ptr_type>( p );
+		auto v2 = v;
+		assert( v2->id() == 2 );
+		auto n = decltype( v ){};
+		auto n2 = n;	// copy of null through the adapted copier
+		assert( !n2 );
+
+		auto w = static_cast<holder::value_ptr_type>( std::move( p ) );
+		assert( p.valueless_after_move() && w->id() == 2 );
+	}
+}
+
+void alignment_tests() {
+
+	struct alignas( 64 ) Simd { float v[16]; };
+	auto is_aligned = []( const void* ptr, std::size_t align ) { return reinterpret_cast<std::uintptr_t>( ptr ) % align == 0; };
+
+	// make_value and the factories built on it honour alignof(T) with aligned new; without it they do not compile
+#if defined( __cpp_aligned_new )
+	{
+		value_ptr<Simd> a = make_value<Simd>();
+		assert( is_aligned( a.get(), 64 ) );
+		a->v[3] = 1.f;
+		auto b = a;
+		assert( is_aligned( b.get(), 64 ) );
+		assert( b->v[3] == 1.f );
+
+		value_ptr<Simd> w = make_value_for_overwrite<Simd>();
+		assert( is_aligned( w.get(), 64 ) );
+
+		indirect<Simd> i = make_indirect<Simd>();
+		assert( is_aligned( &*i, 64 ) );
+		auto i2 = i;
+		assert( is_aligned( &*i2, 64 ) );
+
+		lazy_value_ptr<Simd> l = make_lazy_value<Simd>();
+		assert( is_aligned( l.get(), 64 ) );
+		auto l2 = l;
+		assert( is_aligned( l2.get(), 64 ) );
+
+		versioned_ptr<Simd> v = make_versioned<Simd>();
+		auto v2 = v;
+		v2.write().v[0] = 2.f;	// copy on write
+		assert( is_aligned( v.get(), 64 ) && is_aligned( v2.get(), 64 ) );
+	}
+#endif
+
+	// aligned policies honour alignof(T) on every standard
+	{
+		auto a = make_value_aligned<Simd>();
+		assert( is_aligned( a.get(), 64 ) );
+		a->v[3] = 1.f;
+		auto b = a;
+		assert( is_aligned( b.get(), 64 ) );
+		assert( b->v[3] == 1.f );
+
+		auto w = make_value_aligned_for_overwrite<Simd>();
+		assert( is_aligned( w.get(), 64 ) );
+	}
+
+	// explicit alignment
+	{
+		auto a = make_value_aligned<A, 256>( 5 );
+		assert( is_aligned( a.get(), 256 ) );
+		auto b = a;
+		assert( is_aligned( b.get(), 256 ) );
+		assert( b->foo == 5 );
+		value_ptr_aligned<A, 256> c{};
+		auto d = c;	// copy of null
+		assert( !d );
+	}
+
+	// cache-line isolated pointees never share a line
+	{
+		static_assert( sizeof( value_ptr_cache_aligned<int> ) == sizeof( int* ), "Size check fail" );
+		std::vector<value_ptr_cache_aligned<int>> counters;
+		for ( int i = 0; i < 8; ++i )
+			counters.push_back( make_value_cache_aligned<int>( i ) );
+		for ( auto& c : counters )
+			assert( is_aligned( c.get(), cache_line_size ) );
+		auto copy = counters;
+		for ( int i = 0; i < 8; ++i ) {
+			assert( *copy[i] == i );
+			assert( is_aligned( copy[i].get(), cache_line_size ) );
+		}
+	}
+}
+
+void erased_tests() {
+
+	static_assert( sizeof( value_ptr_erased<A> ) == 2 * sizeof( A* ), "Size check fail" );
+
+	// records are constant initialized, usable from other translation units' static initializers
+	static_assert( detail::erased_ops_for<A, A>::value.tag == detail::type_tag<A>(), "constant init check fail" );
+	assert( detail::type_tag<A>() != detail::type_tag<int>() );
+
+	// no clone(), no vtable, no virtual destructor on Base
+	static int derived_destroyed = 0;
+	struct Base { int foo; };
+	struct Derived : Base {
+		std::string name;
+		Derived( int foo_, std::string name_ ) : Base{ foo_ }, name( std::move( name_ ) ) {}
+		Derived( const Derived& ) = default;
+		~Derived() { ++derived_destroyed; }
+	};
+
+	{
+		value_ptr_erased<Base> a = make_value_erased<Base, Derived>( 1, "derived" );
+		auto b = a;	// Derived's copy constructor, through the recorded routine
+		assert( b.get() != a.get() );
+		assert( b->foo == 1 );
+		assert( static_cast<Derived*>( b.get() )->name == "derived" );
+
+		auto c = b;	// record carried to copies
+		assert( static_cast<Derived*>( c.get() )->name == "derived" );
+		assert( c.get_deleter().ops == a.get_deleter().ops );	// record shared per type
+
+		a = make_value_erased_ptr<Base>( new Derived( 2, "other" ) );
+		assert( static_cast<Derived*>( a.get() )->name == "other" );
+
+		value_ptr_erased<Base> n{};
+		auto m = n;	// copy of null
+		assert( !m );
+
+		auto p = make_value_erased<Base>( Base{ 4 } );	// Base itself
+		auto q = p;
+		assert( q->foo == 4 );
+	}
+	assert( derived_destroyed == 4 );	// Derived destructor ran for every Derived: a (original), b, c, a (reassigned)
+
+	// polymorphic hierarchy without clone()
+	{
+		struct Shape { virtual int sides() const = 0; virtual ~Shape() = default; };
+		struct Square : Shape { int sides() const override { return 4; } };
+		auto a = make_value_erased<Shape, Square>();
+		auto b = a;
+		assert( b->sides() == 4 );
+	}
+}
+
+void tagged_tests() {
+
+	struct Base {
+		virtual ~Base() = default;
+		virtual Base* clone() const { return new Base( *this ); }
+	};
+	struct Derived : Base { Derived* clone() const override { return new Derived( *this ); } };
+	struct Derived2 : Base { Derived2* clone() const override { return new Derived2( *this ); } };
+
+	// plain value_ptr, typeid fallback
+	{
+		value_ptr<Base> a( new Derived() );
+		assert( a.holds<Derived>() );
+		assert( !a.holds<Base>() );
+		assert( a.get_as<Derived>() == a.get() );
+		assert( a.get_as<Derived2>() == nullptr );
+
+		value_ptr<Base> n;
+		assert( !n.holds<Base>() && n.get_as<Base>() == nullptr );
+
+		value_ptr<Base> b = make_value<Derived>();	// converting move
+		assert( b.holds<Derived>() );
+	}
+
+	// tag kept in the deleter
+	{
+		static_assert( sizeof( value_ptr_tagged<Base> ) == 2 * sizeof( Base* ), "Size check fail" );
+
+		value_ptr_tagged<Base> a( new Derived() );
+		assert( a.holds<Derived>() && !a.holds<Derived2>() && !a.holds<Base>() );
+
+		// binding checks that the static type is the dynamic type; a base pointer to a derived object would be tagged wrongly
+		const Derived derived{};
+		const Base& base = derived;
+		assert( detail::is_dynamic_type( &derived, std::true_type() ) );
+		assert( !detail::is_dynamic_type( &base, std::true_type() ) );
+
+		auto b = a;	// tag carried to copies
+		assert( b.get_as<Derived>() == b.get() );
+
+		b.reset( new Derived2() );	// rebound on reset
+		assert( b.holds<Derived2>() && !b.holds<Derived>() );
+
+		b.reset();
+		assert( !b.holds<Derived2>() && b.get_as<Derived2>() == nullptr );
+
+		value_ptr_tagged<Base> c( new Base() );
+		assert( c.holds<Base>() );
+
+		value_ptr_tagged<Derived> d( new Derived() );
+		value_ptr_tagged<Base> e = std::move( d );	// converting move keeps the most-derived tag
+		assert( !d );
+		assert( e.holds<Derived>() && !e.holds<Base>() );
+	}
+
+	// value_ptr_erased exposes its record's tag
+	{
+		struct Plain { int foo; };
+		struct Derived3 : Plain {};
+		auto a = make_value_erased<Plain, Derived3>();
+		assert( a.holds<Derived3>() && !a.holds<Plain>() );
+
+		auto b = a;
+		b.reset( new Plain{ 1 } );	// record rebound on reset
+		assert( b.holds<Plain>() );
+		auto c = b;
+		assert( c.holds<Plain>() && c->foo == 1 );
+	}
+}
+
+void traversal_tests() {
+
+	struct Shape {
+		virtual ~Shape() = default;
+		virtual Shape* clone() const = 0;
+		virtual int sides() const = 0;
+	};
+	struct Triangle : Shape { Triangle* clone() const override { return new Triangle( *this ); } int sides() const override { return 3; } };
+	struct Square : Shape { Square* clone() const override { return new Square( *this ); } int sides() const override { return 4; } };
+
+	std::vector<value_ptr<Shape>> shapes;
+	shapes.emplace_back( new Square() );
+	shapes.emplace_back( new Triangle() );
+	shapes.emplace_back( nullptr );
+	shapes.emplace_back( new Square() );
+	shapes.emplace_back( new Triangle() );
+	shapes.emplace_back( new Square() );
+
+	// prefetched; same elements, same order, any distance
+	for ( std::size_t distance : { std::size_t( 0 ), std::size_t( 2 ), std::size_t( 100 ) } ) {
+		std::size_t i = 0;
+		for ( auto& p : prefetched( shapes, distance ) )
+			assert( &p == &shapes[i++] );
+		assert( i == shapes.size() );
+	}
+	{
+		const std::vector<value_ptr<Shape>>& cshapes = shapes;
+		int total = 0;
+		for ( const auto& p : prefetched( cshapes ) )
+			total += p ? p->sides() : 0;
+		assert( total == 18 );
+
+		std::vector<value_ptr<Shape>> empty;
+		assert( prefetched( empty ).begin() == prefetched( empty ).end() );
+	}
+
+	// by_dynamic_type; grouped in order of first appearance, stable within a type, nulls skipped
+	{
+		const auto sorted = by_dynamic_type( shapes );
+		assert( sorted.size() == 5 );
+		assert( sorted[0] == shapes[0].get() && sorted[1] == shapes[3].get() && sorted[2] == shapes[5].get() );
+		assert( sorted[3] == shapes[1].get() && sorted[4] == shapes[4].get() );
+
+		int sides = 0;
+		for_each_by_dynamic_type( shapes, [&]( Shape& s ) { sides = sides * 10 + s.sides(); } );
+		assert( sides == 44433 );
+	}
+
+	// tagged elements are grouped by the deleter's tag
+	{
+		std::vector<value_ptr_tagged<Shape>> tagged;
+		tagged.emplace_back( new Triangle() );
+		tagged.emplace_back( new Square() );
+		tagged.emplace_back( new Triangle() );
+		const auto sorted = by_dynamic_type( tagged );
+		assert( sorted.size() == 3 && sorted[0] == tagged[0].get() && sorted[1] == tagged[2].get() && sorted[2] == tagged[1].get() );
+	}
+
+	// non-polymorphic; one group, original order
+	{
+		std::vector<value_ptr<A>> as;
+		as.emplace_back( new A( 1 ) );
+		as.emplace_back( new A( 2 ) );
+		const auto sorted = by_dynamic_type( as );
+		assert( sorted.size() == 2 && sorted[0]->foo == 1 && sorted[1]->foo == 2 );
+	}
+}
+
+namespace {
+	// stateful copier counting copies, for value_any policy tests
+	template <typename T>
+	struct counting_copy {
+		int* copies = nullptr;
+		counting_copy() = default;
+		explicit counting_copy( int* copies_ ) : copies( copies_ ) {}
+		T* operator()( const T* what ) const {
+			++*this->copies;
+			return new T( *what );
+		}
+	};
+}
+
+void any_tests() {
+
+	static_assert( sizeof( value_any ) == 4 * sizeof( void* ), "Size check fail" );
+	static_assert( value_any::stores_inline<int>::value && value_any::stores_inline<std::string>::value == ( sizeof( std::string ) <= 3 * sizeof( void* ) ), "inline check fail" );
+
+	struct Big { char data[256]; int val; };
+	static_assert( !value_any::stores_inline<Big>::value, "inline check fail" );
+
+	// inline and heap values, exact type access
+	{
+		value_any a = 42;
+		assert( a.has_value() && a.type() == typeid( int ) );
+		assert( a.get_if<int>() && *a.get_if<int>() == 42 );
+		assert( a.get_if<long>() == nullptr );
+
+		value_any b = a;	// deep copy
+		*b.get_if<int>() = 7;
+		assert( *a.get_if<int>() == 42 && *b.get_if<int>() == 7 );
+
+		Big big{};
+		big.val = 3;
+		a = big;
+		assert( a.get_if<int>() == nullptr && a.get_if<Big>()->val == 3 );
+		b = a;
+		assert( b.get_if<Big>() != a.get_if<Big>() && b.get_if<Big>()->val == 3 );
+
+		value_any c = std::move( b );
+		assert( !b.has_value() && b.type() == typeid( void ) && c.get_if<Big>()->val == 3 );
+
+		swap( a, b );
+		assert( !a.has_value() && b.get_if<Big>() );
+
+		b.reset();
+		assert( !b.has_value() && b.get_if<Big>() == nullptr );
+
+		const value_any s = make_value_any<std::string>( 3, 'x' );
+		assert( *s.get_if<std::string>() == "xxx" );
+
+		value_any e;
+		assert( !e.has_value() && e.get_if<int>() == nullptr );
+	}
+
+	// polymorphic values held through value_ptr; copies use clone()
+	{
+		struct Base {
+			virtual ~Base() = default;
+			virtual Base* clone() const = 0;
+			virtual int id() const = 0;
+		};
+		struct Derived : Base {
+			Derived* clone() const override { return new Derived( *this ); }
+			int id() const override { return 2; }
+		};
+		static_assert( !value_any::stores_inline<Base>::value, "inline check fail" );
+
+		value_any a = value_ptr<Base>( new Derived() );
+		assert( a.type() == typeid( Base ) && a.get_if<Base>()->id() == 2 );
+		value_any b = a;
+		assert( b.get_if<Base>() != a.get_if<Base>() && b.get_if<Base>()->id() == 2 );
+
+		value_any n = value_ptr<Base>();	// null
+		assert( !n.has_value() );
+
+		value_any i = make_value<int>( 5 );	// fits inline; moved into the buffer
+		assert( *i.get_if<int>() == 5 );
+
+		auto source = make_value<int>( 6 );	// adopted pointers are left null on both paths
+		value_any j( std::move( source ) );
+		assert( !source && *j.get_if<int>() == 6 );
+		value_ptr<Base> heap_source( new Derived() );
+		value_any k( std::move( heap_source ) );
+		assert( !heap_source && k.get_if<Base>()->id() == 2 );
+	}
+
+	// stateful copier policy
+	{
+		static int copies = 0;
+		using any_type = basic_value_any<4 * sizeof( void* ), alignof( void* ), std::default_delete, counting_copy>;
+		static_assert( !any_type::stores_inline<int>::value, "custom copier forces heap storage" );
+
+		any_type a = any_type::value_ptr_type<int>( new int( 1 ), std::default_delete<int>(), counting_copy<int>( &copies ) );
+		any_type b = a;
+		any_type c = b;
+		assert( copies == 2 && *c.get_if<int>() == 1 );
+		assert( c.get_if<int>() != a.get_if<int>() );
+	}
+
+	// policy owning its allocation; values adopted from the policy's factory, copies and release go through the pool
+	{
+		using any_type = basic_value_any<3 * sizeof( void* ), alignof( void* ), pool_deleter, pool_copier>;
+		static_assert( !any_type::stores_inline<int>::value, "pool policy forces heap storage" );
+
+		any_type a = make_value_pooled<int>( 5 );
+		any_type b = a;
+		assert( *b.get_if<int>() == 5 && b.get_if<int>() != a.get_if<int>() );
+		a.reset();
+		assert( *b.get_if<int>() == 5 );
+	}
+
+	// custom buffer size/alignment
+	{
+		struct alignas( 16 ) Vec4 { float v[4]; };
+		static_assert( !value_any::stores_inline<Vec4>::value, "inline check fail" );
+		using any_type = basic_value_any<sizeof( Vec4 ), alignof( Vec4 )>;
+		static_assert( any_type::stores_inline<Vec4>::value, "inline check fail" );
+
+		any_type a = Vec4{ { 1, 2, 3, 4 } };
+		assert( reinterpret_cast<std::uintptr_t>( a.get_if<Vec4>() ) % 16 == 0 && a.get_if<Vec4>()->v[3] == 4 );
+	}
+}
+
+void versioned_tests() {
+
+	static_assert( sizeof( versioned_ptr<A> ) == sizeof( A* ), "Size check fail" );
+
+	static int live_leaves = 0;
+	struct Leaf {
+		int val;
+		Leaf( int val_ ) : val( val_ ) { ++live_leaves; }
+		Leaf( const Leaf& that ) : val( that.val ) { ++live_leaves; }
+		~Leaf() { --live_leaves; }
+	};
+	struct Branch {
+		versioned_ptr<Leaf> left, right;
+	};
+	struct Root {
+		versioned_ptr<Branch> a, b;
+		int counter = 0;
+	};
+
+	auto make_state = []() {
+		Root root;
+		for ( auto* branch : { &root.a, &root.b } ) {
+			Branch br;
+			br.left = make_versioned<Leaf>( 1 );
+			br.right = make_versioned<Leaf>( 2 );
+			*branch = make_versioned<Branch>( std::move( br ) );
+		}
+		return make_versioned<Root>( std::move( root ) );
+	};
+
+	{
+		version_history<Root> history( make_state() );
+		assert( live_leaves == 4 );
+
+		const auto v0 = history.commit();
+		assert( history.current().shares( history.at( v0 ) ) );	// O(1), nothing copied
+		assert( live_leaves == 4 );
+
+		// path copy:  root -> a -> a.left
+		history.current().write().a.write().left.write().val = 10;
+		assert( live_leaves == 5 );
+		const Root& now = *history.current();
+		const Root& old = *history.at( v0 );
+		assert( !history.current().shares( history.at( v0 ) ) );
+		assert( !now.a.shares( old.a ) && now.b.shares( old.b ) );	// sibling subtree shared
+		assert( !now.a->left.shares( old.a->left ) && now.a->right.shares( old.a->right ) );
+		assert( now.a->left->val == 10 && old.a->left->val == 1 );
+
+		// unshared nodes are written in place
+		history.current().write().a.write().left.write().val = 11;
+		assert( live_leaves == 5 );
+
+		const auto v1 = history.commit();
+		history.current().write().counter = 1;	// copies the root only
+		assert( live_leaves == 5 );
+		assert( history.current()->a.shares( history.at( v1 )->a ) );
+
+		// rollback
+		history.rollback( v0 );
+		assert( history.current()->a->left->val == 1 && history.current()->counter == 0 );
+		assert( history.contains( v1 ) && history.at( v1 )->a->left->val == 11 );
+
+		// reclamation
+		assert( history.size() == 2 );
+		history.drop( v1 );
+		assert( !history.contains( v1 ) && history.size() == 1 );
+		assert( live_leaves == 4 );	// leaf 11 reclaimed
+		history.drop_before( v1 );
+		assert( history.size() == 0 && !history.contains( v0 ) );
+		assert( live_leaves == 4 );	// still held by the current state
+
+		// to_value_ptr; deep copy of the root
+		auto copy = history.current()->a.to_value_ptr();
+		assert( copy->left.shares( history.current()->a->left ) );
+
+		history.current().reset();
+	}
+	assert( live_leaves == 0 );
+
+	// copies share until written
+	{
+		auto x = make_versioned<Leaf>( 5 );
+		auto y = x;
+		assert( x.use_count() == 2 && !x.unique() && x.get() == y.get() );
+		y.write().val = 6;
+		assert( x.unique() && y.unique() && x->val == 5 && y->val == 6 );
+
+		versioned_ptr<Leaf> n;
+		assert( !n && n.use_count() == 0 && n.get() == nullptr );
+	}
+	assert( live_leaves == 0 );
+}
+
+void batch_tests() {
+
+	// make_value_for_overwrite; default-initialized
+	{
+		struct Buffer { unsigned char bytes[4096]; };
+		auto a = make_value_for_overwrite<Buffer>();
+		a->bytes[0] = 1;
+		auto b = a;
+		assert( b->bytes[0] == 1 );
+
+		auto s = make_value_for_overwrite<std::string>();	// class types are still constructed
+		assert( s->empty() );
+	}
+
+	static_assert( sizeof( value_ptr_batched<A> ) == sizeof( A* ), "Size check fail" );
+
+	static int live = 0;
+	struct Item {
+		std::string name;
+		int val;
+		Item( const std::string& name_, int val_ ) : name( name_ ), val( val_ ) { ++live; }
+		Item( const Item& that ) : name( that.name ), val( that.val ) { ++live; }
+		~Item() { --live; }
+	};
+
+	{
+		auto items = make_values<Item>( 5, std::string( "item" ), 7 );
+		assert( items.size() == 5 && live == 5 );
+		for ( auto& item : items )
+			assert( item->name == "item" && item->val == 7 );
+		assert( items[1].get() != items[0].get() );
+
+		// copies are allocated individually
+		auto copy = items[2];
+		copy->val = 8;
+		assert( items[2]->val == 7 && live == 6 );
+
+		// elements released independently, in any order
+		items[0].reset();
+		items[3] = copy;
+		auto moved = std::move( items[4] );
+		items.clear();
+		assert( live == 2 && moved->val == 7 );
+
+		copy.reset();
+		assert( live == 1 );
+	}
+	assert( live == 0 );
+
+	assert( make_values<Item>( 0, std::string(), 0 ).empty() );
+
+	// over-aligned elements
+	{
+		struct alignas( 32 ) Vec { double v[4]; Vec() : v{ 1, 2, 3, 4 } {} };
+		auto vecs = make_values<Vec>( 3 );
+		for ( auto& v : vecs )
+			assert( reinterpret_cast<std::uintptr_t>( v.get() ) % 32 == 0 && v->v[3] == 4 );
+		auto copy = vecs[0];
+		assert( reinterpret_cast<std::uintptr_t>( copy.get() ) % 32 == 0 );
+	}
+
+	// constructor throwing part way
+	{
+		static int constructed = 0;
+		struct Fragile {
+			Fragile() { if ( ++constructed == 3 ) throw 1; ++live; }
+			~Fragile() { --live; }
+		};
+		bool thrown = false;
+		try {
+			make_values<Fragile>( 5 );
+		}
+		catch ( int ) {
+			thrown = true;
+		}
+		assert( thrown && live == 0 );
+	}
+}
+
+// compile time construction, copy, clone and destruction; requires constexpr std::unique_ptr (C++23)
+#if defined( __cpp_lib_constexpr_memory ) && __cpp_lib_constexpr_memory >= 202202L
+namespace {
+	struct Rule {
+		int weight;
+		constexpr Rule( int weight_ ) : weight( weight_ ) {}
+	};
+
+	struct Prototype {
+		constexpr virtual ~Prototype() = default;
+		constexpr virtual Prototype* clone() const = 0;
+		constexpr virtual int id() const = 0;
+	};
+
+	struct ConcretePrototype : Prototype {
+		int value;
+		constexpr ConcretePrototype( int value_ ) : value( value_ ) {}
+		constexpr ~ConcretePrototype() override {}
+		constexpr ConcretePrototype* clone() const override { return new ConcretePrototype( *this ); }
+		constexpr int id() const override { return this->value; }
+	};
+
+	constexpr int rule_table_sum() {
+		value_ptr<Rule> table[3] = { make_value<Rule>( 1 ), make_value<Rule>( 2 ), make_value<Rule>( 3 ) };
+		value_ptr<Rule> copy = table[1];	// deep copy via default_copy
+		copy->weight = 20;
+		table[2].reset( new Rule( 30 ) );
+		table[0].reset();
+		int sum = copy->weight;
+		for ( const auto& rule : table )
+			sum += rule ? rule->weight : 0;
+		return sum;	// 20 + 0 + 2 + 30
+	}
+
+	constexpr int prototype_clone() {
+		value_ptr<Prototype> a( new ConcretePrototype( 7 ) );
+		value_ptr<Prototype> b = a;	// clone() detected and called
+		value_ptr<Prototype> c;
+		c = std::move( b );
+		return c->id() + ( a.get() != c.get() ) + ( b == nullptr );
+	}
+
+	static_assert( rule_table_sum() == 52, "constexpr table fail" );
+	static_assert( prototype_clone() == 9, "constexpr clone fail" );
+}
+#endif
+
+void constexpr_tests() {
+#if defined( __cpp_lib_constexpr_memory ) && __cpp_lib_constexpr_memory >= 202202L
+	// same functions at run time
+	assert( rule_table_sum() == 52 );
+	assert( prototype_clone() == 9 );
+#endif
+}
+
 int main() {
 
 #ifdef _WIN32
@@ -514,6 +1834,23 @@ int main() {
 	slice_protection();
 	incomplete_tests();
 	unique_ptr_tests();
+	shared_policy_tests();
+	pool_tests();
+	graph_tests();
+	hash_tests();
+	interned_tests();
+	lazy_tests();
+	cow_tests();
+	indirect_tests();
+	alignment_tests();
+	erased_tests();
+	tagged_tests();
+	audit_tests();
+	traversal_tests();
+	any_tests();
+	versioned_tests();
+	batch_tests();
+	constexpr_tests();
 
 	std::cout << "All tests passed" << std::endl;
 	return 0;
@@ -0,0 +1,132 @@
+// copy audit enabled for this TU only; value_ptr types used here must not be shared with non-audited TUs
+#ifndef VALUE_PTR_AUDIT_COPIES
+#define VALUE_PTR_AUDIT_COPIES
+#endif
+
+#include <cassert>
+#include <sstream>
+#include <utility>
+
+#include "../value_ptr.hpp"
+#include "../value_ptr_indirect.hpp"
+#include "test-audit.hpp"
+
+namespace {
+	using namespace smart_ptr;
+
+	struct payload { int val; };
+
+	std::size_t total_sampled() {
+		std::size_t n = 0;
+		for ( const auto& site : copy_audit::report() )
+			n += site.sampled;
+		return n;
+	}
+
+	copy_audit_site totals() {
+		copy_audit_site result;
+		for ( const auto& site : copy_audit::report() ) {
+			result.sampled += site.sampled;
+			result.destroyed += site.destroyed;
+			result.moved_from += site.moved_from;
+			result.reassigned += site.reassigned;
+		}
+		return result;
+	}
+}
+
+void audit_tests() {
+
+	copy_audit::set_sample_rate( 1 );
+	copy_audit::set_window( 16 );
+	copy_audit::clear();
+
+	// source destroyed right after the copy
+	{
+		value_ptr<payload> b;
+		{
+			value_ptr<payload> a( new payload{ 1 } );
+			b = a;
+		}
+		assert( b->val == 1 );
+	}
+	assert( totals().sampled == 1 && totals().destroyed == 1 );
+
+	// source read after the copy; copy was necessary
+	{
+		value_ptr<payload> a( new payload{ 2 } );
+		value_ptr<payload> b = a;
+		assert( a->val == 2 && b->val == 2 );
+	}
+	assert( totals().sampled == 2 && totals().avoidable() == 1 );
+
+	// source moved from, then reset
+	{
+		value_ptr<payload> a( new payload{ 3 } );
+		value_ptr<payload> b = a;
+		value_ptr<payload> c = std::move( a );
+
+		value_ptr<payload> d = b;
+		b.reset( new payload{ 4 } );
+
+		value_ptr<payload> e = c;
+		c = d;	// assigned over
+	}
+	{
+		const copy_audit_site t = totals();
+		assert( t.sampled == 6 );
+		assert( t.destroyed == 2 && t.moved_from == 1 && t.reassigned == 2 );	// d, copied into c, then destroyed unread
+	}
+
+	// swap keeps both values alive; not flagged
+	{
+		value_ptr<payload> a( new payload{ 5 } ), b;
+		value_ptr<payload> c = a;
+		a.swap( b );
+	}
+	assert( totals().avoidable() == 5 );
+
+	// copies through other holders sharing ptr_data
+	{
+		indirect<payload> a( payload{ 6 } );
+		indirect<payload> b = a;
+		assert( a->val == 6 );
+	}
+	assert( totals().avoidable() == 5 );
+
+	// report is ranked
+	{
+		const auto sites = copy_audit::report();
+		assert( !sites.empty() );
+		for ( std::size_t i = 1; i < sites.size(); ++i )
+			assert( sites[i - 1].avoidable() >= sites[i].avoidable() );
+
+		std::ostringstream os;
+		copy_audit::print_report( os, 3 );
+		assert( os.str().find( "avoidable" ) != std::string::npos );
+	}
+
+	// sampling; one in four copies recorded
+	copy_audit::clear();
+	copy_audit::set_sample_rate( 4 );
+	{
+		value_ptr<payload> a( new payload{ 7 } );
+		for ( int i = 0; i < 8; ++i ) {
+			value_ptr<payload> b = a;
+			(void)b;
+		}
+	}
+	assert( total_sampled() == 2 );
+
+	// disabled
+	copy_audit::clear();
+	copy_audit::set_sample_rate( 0 );
+	{
+		value_ptr<payload> a( new payload{ 8 } );
+		value_ptr<payload> b = a;
+		(void)b;
+	}
+	assert( copy_audit::report().empty() );
+
+	copy_audit::set_sample_rate( 1 );
+}
@@ -0,0 +1,7 @@
+#ifndef TEST_AUDIT
+#define TEST_AUDIT
+
+// copy audit tests; test-audit.cpp is compiled with VALUE_PTR_AUDIT_COPIES, using types local to that TU
+void audit_tests();
+
+#endif
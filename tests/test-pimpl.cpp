@@ -77,4 +77,25 @@ int widget::get_meaning_of_life_derived() const {
 	return this->pImpl_derived->meaning_of_life();
 }
 
-bool widget::is_clone_derived() const { return static_cast<const impl_derived&>( *this->pImpl_derived ).is_clone; }
\ No newline at end of file
+bool widget::is_clone_derived() const { return static_cast<const impl_derived&>( *this->pImpl_derived ).is_clone; }
+
+// define fast pimpl impl; owns a heap int so copies/moves/destruction are observable
+struct fast_widget::impl {
+	static int live;
+	int* val;
+
+	impl( int val_ ) : val( new int( val_ ) ) { ++live; }
+	impl( const impl& that ) : val( new int( *that.val ) ) { ++live; }
+	impl( impl&& that ) : val( that.val ) { that.val = nullptr; ++live; }
+	~impl() { delete val; --live; }
+};
+
+int fast_widget::impl::live = 0;
+
+fast_widget::fast_widget() { this->pImpl.emplace( 42 ); }
+
+int fast_widget::get_meaning_of_life() const { return *this->pImpl->val; }
+
+void fast_widget::set_meaning_of_life( int val ) { *this->pImpl->val = val; }
+
+int fast_widget::live_impls() { return impl::live; }
\ No newline at end of file
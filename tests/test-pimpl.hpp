@@ -30,5 +30,19 @@ public:
 	smart_ptr::value_ptr<impl, impl_deleter, impl_copier> pImpl_custom;
 };	// widget
 
+// fast pimpl widget; impl held inline, no heap allocation
+class fast_widget {
+public:
+	fast_widget();
+
+	struct impl;
+	smart_ptr::value_ptr_incomplete_inline<impl, 2 * sizeof( void* ), alignof( void* )> pImpl;
+
+	int get_meaning_of_life() const;
+	void set_meaning_of_life( int );
+
+	static int live_impls();	// number of constructed, not yet destroyed impls
+};	// fast_widget
+
 #endif
 
@@ -10,6 +10,35 @@
 #include <memory>		// std::unique_ptr
 #include <functional>	// std::less
 #include <cassert>		// assert
+#include <cstddef>		// std::size_t, std::max_align_t
+#include <cstdint>		// std::uintptr_t
+#include <new>			// operator new, placement new, std::align_val_t
+#include <typeinfo>		// typeid
+
+// cache line size used by the cache-line isolated policies; may be defined by the user
+#ifndef VALUE_PTR_CACHE_LINE_SIZE
+#define VALUE_PTR_CACHE_LINE_SIZE 64
+#endif
+
+// copy audit hooks; define VALUE_PTR_AUDIT_COPIES for the whole program to report avoidable deep copies, see value_ptr_audit.hpp
+#if defined( VALUE_PTR_AUDIT_COPIES )
+#include "value_ptr_audit.hpp"
+#define VALUE_PTR_AUDIT_COPY( source ) ::smart_ptr::detail::audit_copy( source )
+#define VALUE_PTR_AUDIT_READ( object ) ::smart_ptr::detail::audit_read( object )
+#define VALUE_PTR_AUDIT_END( object, outcome ) ::smart_ptr::detail::audit_end( object, ::smart_ptr::copy_audit_outcome::outcome )
+#else
+#define VALUE_PTR_AUDIT_COPY( source ) ( (void)0 )
+#define VALUE_PTR_AUDIT_READ( object ) ( (void)0 )
+#define VALUE_PTR_AUDIT_END( object, outcome ) ( (void)0 )
+#endif
+
+// constexpr for members which allocate, copy or destroy; requires constexpr new/delete (C++20) and a constexpr std::unique_ptr (C++23, P2273)
+//	not with the copy audit, whose hooks run at run time
+#if defined( __cpp_constexpr_dynamic_alloc ) && defined( __cpp_lib_constexpr_memory ) && __cpp_lib_constexpr_memory >= 202202L && !defined( VALUE_PTR_AUDIT_COPIES )
+#define VALUE_PTR_CONSTEXPR_DYNAMIC constexpr
+#else
+#define VALUE_PTR_CONSTEXPR_DYNAMIC
+#endif
 
 #if defined( _MSC_VER)	
 
@@ -46,22 +75,101 @@ namespace smart_ptr {
 		>::type 
 		{};
 
+		// true if plain new honours alignof(T); always with aligned new (C++17), otherwise only up to max_align_t
+		template <typename T>
+		struct is_new_aligned : std::integral_constant<bool,
+#if defined( __cpp_aligned_new )
+			true
+#else
+			alignof(T) <= alignof(std::max_align_t)
+#endif
+		> {};
+
 		// default copier/cloner, analogous to std::default_delete
 		template <typename T>
 		struct default_copy {
 		private:
 			struct _clone_tag {};
 			struct _copy_tag {};
-			T* operator()(const T* what, _clone_tag) const { return what->clone(); }
-			T* operator()(const T* what, _copy_tag) const { return new T(*what); }
+			VALUE_PTR_CONSTEXPR_DYNAMIC T* operator()(const T* what, _clone_tag) const { return what->clone(); }
+			VALUE_PTR_CONSTEXPR_DYNAMIC T* operator()(const T* what, _copy_tag) const {
+				static_assert(is_new_aligned<T>::value, "value_ptr; over-aligned type requires aligned new (C++17), use value_ptr_aligned/make_value");
+				return new T(*what);
+			}
 		public:
-			T* operator()(const T* what) const {	// copy operator
+			default_copy() = default;
+
+			// converting ctor, for converting moves from value_ptr<U>; U must be cloneable
+			template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+			constexpr default_copy(const default_copy<U>&) {
+				static_assert(slice_test<T*, U*, true>::value, "value_ptr; clone() method not detected and not using custom copier; slicing may occur");
+			}
+
+			VALUE_PTR_CONSTEXPR_DYNAMIC T* operator()(const T* what) const {	// copy operator
 				if (!what)
 					return nullptr;
 				return this->operator()(what, typename std::conditional<detail::has_clone<T>::value, _clone_tag, _copy_tag>::type());	// tag dispatch on has_clone
 			}	//
 		};	// default_copy
 
+		// copier may optionally take the deleter as a second argument, for copiers which rely on deleter state
+		template <class C, class T, class D, class = void> struct copier_takes_deleter : std::false_type {};
+		template <class C, class T, class D> struct copier_takes_deleter<C, T, D, decltype(void(std::declval<const C&>()(std::declval<const T*>(), std::declval<const D&>())))> : std::true_type {};
+
+		// deleter may record the static type of the pointer it is constructed or reset with, e.g. a dynamic type tag
+		//	detected by member template:  template <typename U> Deleter bind() const
+		template <class D, class U, class = void> struct deleter_binds : std::false_type {};
+		template <class D, class U> struct deleter_binds<D, U, decltype(void(std::declval<const D&>().template bind<U>()))> : std::true_type {};
+
+		template <typename D, typename Px>
+		struct should_bind_deleter : std::integral_constant<bool,
+			std::is_pointer<Px>::value && deleter_binds<D, typename std::remove_pointer<Px>::type>::value
+		> {};
+
+		// return flag if px points to an object of exactly type U; always true when U is not polymorphic or is abstract (no binding)
+		template <typename U>
+		bool is_dynamic_type(const U* px, std::true_type /*polymorphic, not abstract*/) noexcept { return !px || typeid(*px) == typeid(U); }
+
+		template <typename U>
+		constexpr bool is_dynamic_type(const U*, std::false_type) noexcept { return true; }
+
+		template <typename D, typename Px, typename Dx>
+		constexpr Dx&& bind_deleter(Dx&& dx, const Px&, std::false_type) { return std::forward<Dx>(dx); }
+
+		// the deleter is bound to the pointer's static type, which must be the pointee's dynamic type
+		template <typename D, typename Px, typename Dx>
+		D bind_deleter(Dx&& dx, const Px& px, std::true_type) {
+			using U = typename std::remove_pointer<Px>::type;
+			assert(is_dynamic_type(px, std::integral_constant<bool, std::is_polymorphic<U>::value && !std::is_abstract<U>::value>())
+				&& "value_ptr; deleter binds the static type of the pointer, construct/reset with a pointer to the most derived type");
+			return D(std::forward<Dx>(dx)).template bind<U>();
+		}
+
+		// unique address per type, used as a dynamic type tag
+		//	non-const, so identical code/data folding cannot merge the tags of different types; zero-initialized, so usable in constant initializers
+		template <typename U>
+		struct type_tag_holder { static char tag; };
+
+		template <typename U>
+		char type_tag_holder<U>::tag = 0;
+
+		template <typename U>
+		constexpr const void* type_tag() noexcept { return &type_tag_holder<U>::tag; }
+
+		// deleter exposes the dynamic type tag of the pointee:  const void* type_tag() const
+		template <class D, class = void> struct has_type_tag : std::false_type {};
+		template <class D> struct has_type_tag<D, decltype(void(std::declval<const D&>().type_tag()))> : std::true_type {};
+
+		// exact dynamic type test; a single compare with a type tag, typeid otherwise
+		template <typename U, typename T, typename D>
+		bool holds(const T* ptr, const D&, std::false_type) noexcept { return ptr && ( std::is_polymorphic<T>::value ? typeid(*ptr) == typeid(U) : std::is_same<T, U>::value ); }
+
+		template <typename U, typename T, typename D>
+		bool holds(const T* ptr, const D& deleter, std::true_type /*has_type_tag*/) noexcept {
+			const void* tag = deleter.type_tag();
+			return tag ? ptr && tag == type_tag<U>() : holds<U>(ptr, deleter, std::false_type());	// untagged, e.g. bound to an abstract type
+		}
+
 		// ptr_data:  holds pointer, deleter, copier
 		//	pointer and deleter held in unique_ptr member, this struct is derived from copier to minimize overall footprint
 		//	uses EBCO to solve sizeof(value_ptr<T>) == sizeof(T*) problem
@@ -87,6 +195,37 @@ namespace smart_ptr {
 				, uptr(px, std::forward<Dx>(dx))
 			{}
 
+#if defined( VALUE_PTR_AUDIT_COPIES )
+			// audited special members; a copy is recorded against its source, which is then watched for being read or ending
+			ptr_data( ptr_data&& that ) noexcept( std::is_nothrow_move_constructible<Copier>::value )
+				: copier_type( std::move( that.get_copier() ) )
+				, uptr( std::move( that.uptr ) )
+			{
+				VALUE_PTR_AUDIT_END( &that, moved_from );
+			}
+
+			ptr_data& operator=( ptr_data&& that ) noexcept( std::is_nothrow_move_assignable<Copier>::value ) {
+				VALUE_PTR_AUDIT_END( this, reassigned );
+				VALUE_PTR_AUDIT_END( &that, moved_from );
+				this->get_copier() = std::move( that.get_copier() );
+				this->uptr = std::move( that.uptr );
+				return *this;
+			}
+
+			ptr_data( const ptr_data& that )
+				: ptr_data( ( VALUE_PTR_AUDIT_COPY( &that ), that.clone() ) )
+			{}
+
+			ptr_data& operator=( const ptr_data& that ) {
+				if ( this != &that ) {
+					VALUE_PTR_AUDIT_COPY( &that );
+					*this = that.clone();
+				}
+				return *this;
+			}
+
+			~ptr_data() { VALUE_PTR_AUDIT_END( this, destroyed ); }
+#else
 			ptr_data( ptr_data&& ) = default;
 			ptr_data& operator=( ptr_data&& ) = default;
 			
@@ -94,27 +233,43 @@ namespace smart_ptr {
 				: ptr_data( that.clone() )
 			{}
 
-			ptr_data& operator=( const ptr_data& that ) {
+			VALUE_PTR_CONSTEXPR_DYNAMIC ptr_data& operator=( const ptr_data& that ) {
 				if ( this != &that )
 					*this = that.clone();
 				return *this;
 			}
+#endif
+
+			// pointee access, seen by the copy audit; prefer over uptr.get() and uptr.release()
+			VALUE_PTR_CONSTEXPR_DYNAMIC pointer get() const noexcept {
+				VALUE_PTR_AUDIT_READ( this );
+				return this->uptr.get();
+			}
+
+			VALUE_PTR_CONSTEXPR_DYNAMIC pointer release() noexcept {
+				VALUE_PTR_AUDIT_READ( this );
+				return this->uptr.release();
+			}
 
 			// get_copier, analogous to std::unique_ptr<T>::get_deleter()
-			copier_type& get_copier() noexcept { return *this; }
+			VALUE_PTR_CONSTEXPR_DYNAMIC copier_type& get_copier() noexcept { return *this; }
 
 			// get_copier, analogous to std::unique_ptr<T>::get_deleter()
-			const copier_type& get_copier() const noexcept { return *this; }
+			constexpr const copier_type& get_copier() const noexcept { return *this; }
 
-			ptr_data clone() const {
+			VALUE_PTR_CONSTEXPR_DYNAMIC ptr_data clone() const {
 				// get a copier, use it to clone ptr, construct/return a ptr_data
 				return{ 
-					this->get_copier()(this->uptr.get())
+					this->copy(copier_takes_deleter<Copier, T, Deleter>())
 					, this->uptr.get_deleter()
 					, this->get_copier() 
 				};
 			}
 
+		private:
+			VALUE_PTR_CONSTEXPR_DYNAMIC pointer copy(std::false_type) const { return this->get_copier()(this->uptr.get()); }
+			VALUE_PTR_CONSTEXPR_DYNAMIC pointer copy(std::true_type) const { return this->get_copier()(this->uptr.get(), this->uptr.get_deleter()); }	// copier relies on deleter state
+
 		};	// ptr_data
 	}	// detail
 
@@ -141,7 +296,7 @@ namespace smart_ptr {
 			value_ptr(Px px, Dx&& dx = {}, Cx&& cx = {} ) 
 			: _data(
 				std::forward<Px>(px)
-				, std::forward<Dx>(dx)
+				, detail::bind_deleter<Deleter, Px>(std::forward<Dx>(dx), px, detail::should_bind_deleter<Deleter, Px>())
 				, std::forward<Cx>(cx)
 			)
 		{
@@ -154,9 +309,22 @@ namespace smart_ptr {
 		// construct from unique_ptr, copier
 		VALUE_PTR_CONSTEXPR
 			value_ptr( std::unique_ptr<T, Deleter> uptr, Copier copier = {})
-			: value_ptr(uptr.release(), std::move( uptr.get_deleter() ), std::move(copier))
+			: _data(uptr.release(), std::move( uptr.get_deleter() ), std::move(copier))	// deleter already bound to the pointee
 		{}
 
+		// converting move from value_ptr<U, ...>, analogous to std::unique_ptr; deleter and copier are converted from the source's
+		template <typename U, typename E, typename C, typename = typename std::enable_if<
+			std::is_convertible<typename value_ptr<U, E, C>::pointer, pointer>::value
+			&& std::is_constructible<Deleter, E&&>::value
+			&& std::is_constructible<Copier, C&&>::value
+			>::type>
+		VALUE_PTR_CONSTEXPR_DYNAMIC
+			value_ptr( value_ptr<U, E, C>&& that )
+			: _data(that.get(), Deleter(std::move(that.get_deleter())), Copier(std::move(that.get_copier())))
+		{
+			that.release();
+		}
+
 		// std::nullptr_t, default ctor 
 		explicit
 			VALUE_PTR_CONSTEXPR
@@ -165,37 +333,39 @@ namespace smart_ptr {
 		{}
 
 		// return unique_ptr, ref qualified
-		const unique_ptr_type& uptr() const & noexcept {
+		VALUE_PTR_CONSTEXPR_DYNAMIC const unique_ptr_type& uptr() const & noexcept {
+			VALUE_PTR_AUDIT_READ( &this->_data );
 			return this->_data.uptr;
 		}
 
 		// return unique_ptr, ref qualified
-		unique_ptr_type& uptr() & noexcept {
+		VALUE_PTR_CONSTEXPR_DYNAMIC unique_ptr_type& uptr() & noexcept {
+			VALUE_PTR_AUDIT_READ( &this->_data );
 			return this->_data.uptr;
 		}
 
 		// conversion to unique_ptr, ref qualified
-		operator unique_ptr_type const&() const & noexcept {
+		VALUE_PTR_CONSTEXPR_DYNAMIC operator unique_ptr_type const&() const & noexcept {
 			return this->uptr();
 		}
 
 		// conversion to unique_ptr, ref qualified
-		operator unique_ptr_type& () & noexcept {
+		VALUE_PTR_CONSTEXPR_DYNAMIC operator unique_ptr_type& () & noexcept {
 			return this->uptr();
 		}
 
-		deleter_type& get_deleter() noexcept { return this->uptr().get_deleter(); }
-		const deleter_type& get_deleter() const noexcept { return this->uptr().get_deleter(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC deleter_type& get_deleter() noexcept { return this->_data.uptr.get_deleter(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC const deleter_type& get_deleter() const noexcept { return this->_data.uptr.get_deleter(); }
 
-		copier_type& get_copier() noexcept { return this->_data.get_copier(); }
-		const copier_type& get_copier() const noexcept { return this->_data.get_copier(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC copier_type& get_copier() noexcept { return this->_data.get_copier(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC const copier_type& get_copier() const noexcept { return this->_data.get_copier(); }
 
 		// get pointer
-		pointer get() const noexcept { return this->uptr().get(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC pointer get() const noexcept { return this->_data.get(); }
 
 		// reset pointer to compatible type
 		template <typename Px, typename = typename std::enable_if<std::is_convertible<Px, pointer>::value>::type>
-		void reset(Px px) {
+		VALUE_PTR_CONSTEXPR_DYNAMIC void reset(Px px) {
 
 			static_assert(
 				detail::slice_test<pointer, Px, std::is_same<detail::default_copy<T>, Copier>::value>::value
@@ -206,26 +376,41 @@ namespace smart_ptr {
 		}
 
 		// reset pointer
-		void reset() { this->reset(nullptr); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC void reset() { this->reset(nullptr); }
+
+		// return flag if the pointee's dynamic type is exactly U
+		//	a single compare when the deleter records a type tag (value_ptr_tagged), a typeid compare otherwise
+		//	a tagged deleter answers for the static type of the pointer given at construction/reset (asserted to be the dynamic type),
+		//	so build value_ptr_tagged from a pointer to the most derived type, not from a base pointer returned by a factory
+		template <typename U>
+		bool holds() const noexcept { return detail::holds<U>(this->get(), this->get_deleter(), detail::has_type_tag<Deleter>()); }
+
+		// return pointee as U* if its dynamic type is exactly U, else nullptr
+		template <typename U>
+		U* get_as() const noexcept { return this->holds<U>() ? static_cast<U*>(this->get()) : nullptr; }
 
 		// release pointer
-		pointer release() noexcept {
-			return this->uptr().release();
+		VALUE_PTR_CONSTEXPR_DYNAMIC pointer release() noexcept {
+			return this->_data.release();
 		}	// release
 
 		// return flag if has pointer
-		explicit operator bool() const noexcept {
+		VALUE_PTR_CONSTEXPR_DYNAMIC explicit operator bool() const noexcept {
 			return this->get() != nullptr;
 		}
 
 		// return reference to T, UB if null
-		reference operator*() const noexcept { return *this->get(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC reference operator*() const noexcept { return *this->get(); }
 
 		// return pointer to T
-		pointer operator-> () const noexcept { return this->get(); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC pointer operator-> () const noexcept { return this->get(); }
 
 		// swap with other value_ptr
-		void swap(value_ptr& that) { std::swap(this->_data, that._data); }
+		VALUE_PTR_CONSTEXPR_DYNAMIC void swap(value_ptr& that) {
+			VALUE_PTR_AUDIT_READ( &this->_data );	// both values live on
+			VALUE_PTR_AUDIT_READ( &that._data );
+			std::swap(this->_data, that._data);
+		}
 
 	};	// value_ptr
 
@@ -234,8 +419,8 @@ namespace smart_ptr {
 	template <class T1, class D1, class C1, class T2, class D2, class C2> void swap( value_ptr<T1, D1, C1>& x, value_ptr<T2, D2, C2>& y ) { x.swap( y ); }
 
 	// non-member operators, based on https://en.cppreference.com/w/cpp/memory/unique_ptr/operator_cmp
-	template <class T1, class D1, class C1, class T2, class D2, class C2> bool operator == ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return x.get() == y.get(); }
-	template<class T1, class D1, class C1, class T2, class D2, class C2> bool operator != ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return x.get() != y.get(); }
+	template <class T1, class D1, class C1, class T2, class D2, class C2> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator == ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return x.get() == y.get(); }
+	template<class T1, class D1, class C1, class T2, class D2, class C2> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator != ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return x.get() != y.get(); }
 	template<class T1, class D1, class C1, class T2, class D2, class C2> bool operator < ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) {
 		using common_type = typename std::common_type<typename value_ptr<T1, D1, C1>::pointer, typename value_ptr<T2, D2, C2>::pointer>::type;
 		return std::less<common_type>()( x.get(), y.get() );
@@ -244,10 +429,10 @@ namespace smart_ptr {
 	template<class T1, class D1, class C1, class T2, class D2, class C2> bool operator > ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return y < x; }
 	template<class T1, class D1, class C1, class T2, class D2, class C2> bool operator >= ( const value_ptr<T1, D1, C1>& x, const value_ptr<T2, D2, C2>& y ) { return !( x < y ); }
 
-	template <class T, class D, class C> bool operator == ( const value_ptr<T, D, C>& x, std::nullptr_t ) noexcept { return !x; }
-	template <class T, class D, class C> bool operator == (std::nullptr_t, const value_ptr<T, D, C>& y) noexcept { return !y; }
-	template <class T, class D, class C> bool operator != (const value_ptr<T, D, C>& x, std::nullptr_t) noexcept { return (bool)x; }
-	template <class T, class D, class C> bool operator != (std::nullptr_t, const value_ptr<T, D, C>& y) noexcept { return (bool)y; }
+	template <class T, class D, class C> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator == ( const value_ptr<T, D, C>& x, std::nullptr_t ) noexcept { return !x; }
+	template <class T, class D, class C> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator == (std::nullptr_t, const value_ptr<T, D, C>& y) noexcept { return !y; }
+	template <class T, class D, class C> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator != (const value_ptr<T, D, C>& x, std::nullptr_t) noexcept { return (bool)x; }
+	template <class T, class D, class C> VALUE_PTR_CONSTEXPR_DYNAMIC bool operator != (std::nullptr_t, const value_ptr<T, D, C>& y) noexcept { return (bool)y; }
 
 	template <class T, class D, class C> bool operator < (const value_ptr<T, D, C>& x, std::nullptr_t) { return std::less<typename value_ptr<T, D, C>::pointer>()(x.get(), nullptr); }
 	template <class T, class D, class C> bool operator < (std::nullptr_t, const value_ptr<T, D, C>& y) { return std::less<typename value_ptr<T, D, C>::pointer>()(nullptr, y.get()); }
@@ -261,21 +446,208 @@ namespace smart_ptr {
 	template <class T, class D, class C> bool operator >= (const value_ptr<T, D, C>& x, std::nullptr_t) { return !(x < nullptr); }
 	template <class T, class D, class C> bool operator >= (std::nullptr_t, const value_ptr<T, D, C>& y) { return !(nullptr < y); }
 
+	// cache line size, for value_ptr_cache_aligned
+	constexpr std::size_t cache_line_size = VALUE_PTR_CACHE_LINE_SIZE;
+
+	namespace detail {
+
+		// allocation aligned to Align bytes, size padded to a multiple of Align, on every standard
+		template <std::size_t Align>
+		struct aligned_allocation {
+
+			static_assert( Align != 0 && ( Align & ( Align - 1 ) ) == 0, "value_ptr; alignment must be a power of two" );
+
+			static constexpr std::size_t padded( std::size_t size ) { return ( ( size + Align - 1 ) / Align ) * Align; }
+
+#if defined( __cpp_aligned_new )
+			static void* allocate( std::size_t size ) { return ::operator new( padded( size ), std::align_val_t( Align ) ); }
+			static void deallocate( void* ptr ) noexcept { ::operator delete( ptr, std::align_val_t( Align ) ); }
+#else
+			// over-allocate, keep the original pointer just in front of the aligned block
+			static void* allocate( std::size_t size ) {
+				void* raw = ::operator new( padded( size ) + Align + sizeof( void* ) );
+				const std::uintptr_t aligned = ( reinterpret_cast<std::uintptr_t>( raw ) + sizeof( void* ) + Align - 1 ) & ~std::uintptr_t( Align - 1 );
+				reinterpret_cast<void**>( aligned )[-1] = raw;
+				return reinterpret_cast<void*>( aligned );
+			}
+			static void deallocate( void* ptr ) noexcept { ::operator delete( static_cast<void**>( ptr )[-1] ); }
+#endif
+		};	// aligned_allocation
+
+		// effective alignment; at least alignof(T), 0 requests exactly alignof(T)
+		template <typename T, std::size_t Align>
+		struct effective_alignment : std::integral_constant<std::size_t, ( Align > alignof(T) ) ? Align : alignof(T)> {};
+
+		// construct T in aligned storage
+		template <typename T, std::size_t Align, typename... Args>
+		T* aligned_new( Args&&... args ) {
+			using allocation = aligned_allocation<effective_alignment<T, Align>::value>;
+			void* storage = allocation::allocate( sizeof(T) );
+			try {
+				return ::new( storage ) T( std::forward<Args>( args )... );
+			}
+			catch ( ... ) {
+				allocation::deallocate( storage );
+				throw;
+			}
+		}
+
+		// construct default-initialized T in aligned storage
+		template <typename T, std::size_t Align>
+		T* aligned_new_for_overwrite() {
+			using allocation = aligned_allocation<effective_alignment<T, Align>::value>;
+			void* storage = allocation::allocate( sizeof(T) );
+			try {
+				return ::new( storage ) T;
+			}
+			catch ( ... ) {
+				allocation::deallocate( storage );
+				throw;
+			}
+		}
+
+	}	// detail
+
+	// deleter for pointees created by aligned_copy/make_value_aligned; alignment is max(Align, alignof(T))
+	template <typename T, std::size_t Align = 0>
+	struct aligned_delete {
+		void operator()( T* ptr ) const noexcept {
+			ptr->~T();
+			detail::aligned_allocation<detail::effective_alignment<T, Align>::value>::deallocate( ptr );
+		}
+	};	// aligned_delete
+
+	// copier allocating with alignment max(Align, alignof(T)), size padded to the alignment; not for polymorphic types
+	template <typename T, std::size_t Align = 0>
+	struct aligned_copy {
+		T* operator()( const T* what ) const {
+			static_assert( !detail::has_clone<T>::value, "value_ptr_aligned; clone() results cannot be released by aligned_delete" );
+			if ( !what )
+				return nullptr;
+			return detail::aligned_new<T, Align>( *what );
+		}
+	};	// aligned_copy
+
+	// value_ptr honouring alignof(T) (or Align, if larger) on every standard
+	template <typename T, std::size_t Align = 0>
+	using value_ptr_aligned = value_ptr<T, aligned_delete<T, Align>, aligned_copy<T, Align>>;
+
+	// value_ptr whose pointee occupies whole cache lines, preventing false sharing between pointees
+	template <typename T>
+	using value_ptr_cache_aligned = value_ptr_aligned<T, cache_line_size>;
+
+	// make value_ptr_aligned
+	template <typename T, std::size_t Align = 0, typename... Args>
+	value_ptr_aligned<T, Align> make_value_aligned( Args&&... args ) {
+		return value_ptr_aligned<T, Align>( detail::aligned_new<T, Align>( std::forward<Args>( args )... ) );
+	}
+
+	// make value_ptr_cache_aligned
+	template <typename T, typename... Args>
+	value_ptr_cache_aligned<T> make_value_cache_aligned( Args&&... args ) {
+		return make_value_aligned<T, cache_line_size>( std::forward<Args>( args )... );
+	}
+
+	// make value_ptr_aligned to a default-initialized T, as make_value_for_overwrite
+	template <typename T, std::size_t Align = 0>
+	value_ptr_aligned<T, Align> make_value_aligned_for_overwrite() {
+		return value_ptr_aligned<T, Align>( detail::aligned_new_for_overwrite<T, Align>() );
+	}
+
 	// make value_ptr with default deleter and copier, analogous to std::make_unique
+	//	over-aligned types need aligned new (C++17); before that, use make_value_aligned<T>
 	template<typename T, typename... Args>
-	value_ptr<T> make_value(Args&&... args) {
+	VALUE_PTR_CONSTEXPR_DYNAMIC value_ptr<T> make_value(Args&&... args) {
+		static_assert(detail::is_new_aligned<T>::value, "value_ptr; over-aligned type requires aligned new (C++17), use make_value_aligned");
 		return value_ptr<T>(new T(std::forward<Args>(args)...));
 	}
 
+	// make value_ptr to a default-initialized T, analogous to std::make_unique_for_overwrite
+	//	trivial types and members are left indeterminate instead of zeroed; for buffers which are written before being read
+	template <typename T>
+	value_ptr<T> make_value_for_overwrite() {
+		static_assert(detail::is_new_aligned<T>::value, "value_ptr; over-aligned type requires aligned new (C++17), use make_value_aligned_for_overwrite");
+		return value_ptr<T>( new T );
+	}
+
 	// make a value_ptr from pointer with custom deleter and copier
 	template <typename T, typename Deleter = std::default_delete<T>, typename Copier = detail::default_copy<T>>
-	static inline auto make_value_ptr(T* ptr, Deleter&& dx = {}, Copier&& cx = {}) -> value_ptr<T, Deleter, Copier> {
+	static inline VALUE_PTR_CONSTEXPR_DYNAMIC auto make_value_ptr(T* ptr, Deleter&& dx = {}, Copier&& cx = {}) -> value_ptr<T, Deleter, Copier> {
 		return value_ptr<T, Deleter, Copier>( ptr, std::forward<Deleter>( dx ), std::forward<Copier>(cx) );
 	}	// make_value_ptr
 
+	// deleter recording the dynamic type of the pointee as a tag, for single compare holds()/get_as()
+	//	the tag follows the static type of the pointer passed at construction/reset, is carried to copies and through converting moves
+	template <typename T, typename Deleter = std::default_delete<T>>
+	struct tagged_delete : Deleter {
+
+		const void* tag = nullptr;
+
+		tagged_delete() = default;
+
+		tagged_delete(const Deleter& dx)
+			: Deleter(dx)
+		{}
+
+		// converting ctor, keeps the tag of the most-derived type
+		template <typename U, typename E, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		tagged_delete(const tagged_delete<U, E>& that)
+			: Deleter(static_cast<const E&>(that))
+			, tag(that.tag)
+		{}
+
+		// copy tagged for U; untagged if U is abstract, as the dynamic type is then unknown
+		template <typename U>
+		tagged_delete bind() const {
+			tagged_delete result(*this);
+			result.tag = std::is_abstract<U>::value ? nullptr : detail::type_tag<U>();
+			return result;
+		}
+
+		const void* type_tag() const noexcept { return this->tag; }
+	};	// tagged_delete
+
+	// value_ptr with a dynamic type tag; sizeof == 2 * sizeof(T*)
+	template <typename T, typename Deleter = std::default_delete<T>, typename Copier = detail::default_copy<T>>
+	using value_ptr_tagged = value_ptr<T, tagged_delete<T, Deleter>, Copier>;
+
+	// deep comparison/hash functors, for use as container key policies; compare pointees rather than addresses
+	//	null compares equal to null and orders before non-null
+	struct deep_equal {
+		template <class P1, class P2> bool operator()( const P1& x, const P2& y ) const {
+			return ( x && y ) ? bool( *x == *y ) : ( !x && !y );
+		}
+	};	// deep_equal
+
+	struct deep_less {
+		using is_transparent = void;
+		template <class P1, class P2> bool operator()( const P1& x, const P2& y ) const {
+			return ( x && y ) ? bool( *x < *y ) : ( !x && y );
+		}
+	};	// deep_less
+
+	// hash of pointee via std::hash, 0 for null
+	struct deep_hash {
+		template <class P> std::size_t operator()( const P& p ) const {
+			return p ? std::hash<typename std::decay<decltype( *p )>::type>()( *p ) : 0;
+		}
+	};	// deep_hash
+
 }	// smart_ptr ns
 
+namespace std {
+	// hashes the pointee; consistent with the address comparison of operator== since equal addresses imply equal pointees
+	template <class T, class D, class C>
+	struct hash<smart_ptr::value_ptr<T, D, C>> {
+		std::size_t operator()( const smart_ptr::value_ptr<T, D, C>& p ) const { return smart_ptr::deep_hash()( p ); }
+	};
+}	// std ns
+
 #undef VALUE_PTR_CONSTEXPR
+#undef VALUE_PTR_CONSTEXPR_DYNAMIC
+#undef VALUE_PTR_AUDIT_COPY
+#undef VALUE_PTR_AUDIT_READ
+#undef VALUE_PTR_AUDIT_END
 #undef VALUE_PTR_USE_EMPTY_BASE_OPTIMIZATION
 
 #endif // !SMART_PTR_VALUE_PTR
@@ -0,0 +1,235 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_ANY
+#define SMART_PTR_VALUE_PTR_ANY
+
+#include "value_ptr.hpp"
+
+#include <cstddef>		// std::size_t
+#include <new>			// placement new
+#include <typeinfo>		// typeid, std::type_info
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// copy/move/destroy routines for a payload placed in a value_any buffer
+		struct any_ops {
+			void( *copy )( const void* src, void* dst );
+			void( *move )( void* src, void* dst );	// move constructs into dst, destroys src
+			void( *destroy )( void* storage );
+			const std::type_info& ( *type )();
+		};	// any_ops
+
+		// one shared record per (payload, held type); the record's address identifies the held type
+		//	Payload is either U itself (inline) or a value_ptr<U, ...> owning U on the heap
+		template <typename Payload, typename U>
+		struct any_ops_for {
+			static Payload* payload( void* storage ) noexcept { return static_cast<Payload*>( storage ); }
+
+			static void copy( const void* src, void* dst ) { ::new( dst ) Payload( *static_cast<const Payload*>( src ) ); }
+
+			static void move( void* src, void* dst ) {
+				::new( dst ) Payload( std::move( *payload( src ) ) );
+				payload( src )->~Payload();
+			}
+
+			static void destroy( void* storage ) { payload( storage )->~Payload(); }
+
+			static const std::type_info& type() { return typeid( U ); }
+
+			static constexpr any_ops value{ &copy, &move, &destroy, &type };
+		};	// any_ops_for
+
+		template <typename Payload, typename U>
+		constexpr any_ops any_ops_for<Payload, U>::value;
+
+	}	// detail
+
+	// type-erased, deep-copying holder for a single value of any copyable type, after std::any
+	//	values up to Size bytes, aligned to at most Align, are held inline when they are nothrow movable, not polymorphic and use the default policies
+	//	other values are owned through value_ptr<U, Deleter<U>, Copier<U>> placed in the buffer; copies use Copier<U>, so clone() is honoured
+	//	stateful policies:  construct from value_ptr<U, Deleter<U>, Copier<U>> holding the policy state
+	//	a Deleter other than std::default_delete owns its allocation scheme:  values are then only adopted from value_ptr_type<U> made by the policy's factory
+	template <std::size_t Size = 3 * sizeof( void* )
+		, std::size_t Align = alignof( void* )
+		, template <class> class Deleter = std::default_delete
+		, template <class> class Copier = detail::default_copy
+	>
+	class basic_value_any {
+
+		static_assert( Align != 0 && ( Align & ( Align - 1 ) ) == 0, "value_any; alignment must be a power of two" );
+		static_assert( Size >= sizeof( void* ) && Align >= alignof( void* ), "value_any; buffer must be able to hold a pointer" );
+
+	public:
+		// owning pointer used for values not held inline
+		template <typename U>
+		using value_ptr_type = value_ptr<U, Deleter<U>, Copier<U>>;
+
+		// return flag if U is held inline, without allocation
+		template <typename U>
+		struct stores_inline : std::integral_constant<bool,
+			sizeof( U ) <= Size
+			&& Align % alignof( U ) == 0
+			&& std::is_nothrow_move_constructible<U>::value
+			&& !std::is_polymorphic<U>::value	// may be a derived object, copy through Copier
+			&& std::is_same<Deleter<U>, std::default_delete<U>>::value
+			&& std::is_same<Copier<U>, detail::default_copy<U>>::value
+		> {};
+
+		static constexpr std::size_t buffer_size = Size;
+		static constexpr std::size_t buffer_alignment = Align;
+
+		// empty
+		basic_value_any() noexcept = default;
+
+		basic_value_any( const basic_value_any& that ) {
+			if ( that.ops_ ) {
+				that.ops_->copy( &that.storage_, &this->storage_ );
+				this->ops_ = that.ops_;
+			}
+		}
+
+		basic_value_any( basic_value_any&& that ) noexcept {
+			this->take( that );
+		}
+
+		// hold a copy of value
+		template <typename V, typename U = typename std::decay<V>::type, typename = typename std::enable_if<!std::is_same<U, basic_value_any>::value>::type>
+		basic_value_any( V&& value ) {
+			this->emplace<U>( std::forward<V>( value ) );
+		}
+
+		// take ownership of ptr's pointee, with ptr's deleter and copier state; empty if ptr is null
+		template <typename U>
+		basic_value_any( value_ptr_type<U>&& ptr ) {
+			this->adopt( std::move( ptr ), stores_inline<U>() );
+		}
+
+		~basic_value_any() { this->reset(); }
+
+		basic_value_any& operator=( const basic_value_any& that ) {
+			if ( this != &that )
+				basic_value_any( that ).swap( *this );
+			return *this;
+		}
+
+		basic_value_any& operator=( basic_value_any&& that ) noexcept {
+			if ( this != &that ) {
+				this->reset();
+				this->take( that );
+			}
+			return *this;
+		}
+
+		// destroy the current value and construct U from args; empty if the constructor throws
+		template <typename U, typename... Args>
+		U& emplace( Args&&... args ) {
+			static_assert( std::is_copy_constructible<U>::value || !stores_inline<U>::value, "value_any; U held inline must be copy constructible" );
+			this->reset();
+			U* result = this->construct<U>( stores_inline<U>(), std::forward<Args>( args )... );
+			this->ops_ = &ops_for<U>::value;
+			return *result;
+		}
+
+		// destroy the value
+		void reset() noexcept {
+			if ( this->ops_ ) {
+				this->ops_->destroy( &this->storage_ );
+				this->ops_ = nullptr;
+			}
+		}
+
+		bool has_value() const noexcept { return this->ops_ != nullptr; }
+
+		// type of the value, typeid(void) if empty
+		const std::type_info& type() const noexcept { return this->ops_ ? this->ops_->type() : typeid( void ); }
+
+		// return pointer to the value if it is exactly a U, else nullptr; a single pointer compare
+		template <typename U>
+		U* get_if() noexcept { return this->ops_ == &ops_for<U>::value ? this->element<U>( stores_inline<U>() ) : nullptr; }
+
+		template <typename U>
+		const U* get_if() const noexcept { return const_cast<basic_value_any*>( this )->template get_if<U>(); }
+
+		void swap( basic_value_any& that ) noexcept {
+			basic_value_any temp( std::move( that ) );
+			that = std::move( *this );
+			*this = std::move( temp );
+		}
+
+	private:
+		template <typename U>
+		using ops_for = detail::any_ops_for<typename std::conditional<stores_inline<U>::value, U, value_ptr_type<U>>::type, U>;
+
+		void take( basic_value_any& that ) noexcept {
+			if ( that.ops_ ) {
+				that.ops_->move( &that.storage_, &this->storage_ );
+				this->ops_ = that.ops_;
+				that.ops_ = nullptr;
+			}
+		}
+
+		template <typename U>
+		U* element( std::true_type /*inline*/ ) noexcept { return reinterpret_cast<U*>( &this->storage_ ); }
+
+		template <typename U>
+		U* element( std::false_type ) noexcept { return reinterpret_cast<value_ptr_type<U>*>( &this->storage_ )->get(); }
+
+		template <typename U, typename... Args>
+		U* construct( std::true_type /*inline*/, Args&&... args ) {
+			return ::new( static_cast<void*>( &this->storage_ ) ) U( std::forward<Args>( args )... );
+		}
+
+		template <typename U, typename... Args>
+		U* construct( std::false_type, Args&&... args ) {
+			static_assert( std::is_same<Deleter<U>, std::default_delete<U>>::value, "value_any; Deleter<U> does not release new U, construct from value_ptr_type<U> made by the policy's factory" );
+			return this->place( value_ptr_type<U>( new U( std::forward<Args>( args )... ) ) );
+		}
+
+		template <typename U>
+		U* place( value_ptr_type<U>&& ptr ) noexcept {
+			static_assert( sizeof( value_ptr_type<U> ) <= Size && Align % alignof( value_ptr_type<U> ) == 0, "value_any; deleter/copier state does not fit the buffer" );
+			return ( ::new( static_cast<void*>( &this->storage_ ) ) value_ptr_type<U>( std::move( ptr ) ) )->get();
+		}
+
+		template <typename U>
+		void adopt( value_ptr_type<U>&& ptr, std::true_type /*inline*/ ) {
+			if ( ptr ) {
+				this->emplace<U>( std::move( *ptr ) );
+				ptr.reset();	// ownership taken, as on the heap path
+			}
+		}
+
+		template <typename U>
+		void adopt( value_ptr_type<U>&& ptr, std::false_type ) {
+			if ( ptr ) {
+				this->place( std::move( ptr ) );
+				this->ops_ = &ops_for<U>::value;
+			}
+		}
+
+		alignas( Align ) unsigned char storage_[Size];
+		const detail::any_ops* ops_ = nullptr;
+	};	// basic_value_any
+
+	// value_any with default buffer and policies
+	using value_any = basic_value_any<>;
+
+	template <std::size_t S, std::size_t A, template <class> class D, template <class> class C>
+	void swap( basic_value_any<S, A, D, C>& x, basic_value_any<S, A, D, C>& y ) noexcept { x.swap( y ); }
+
+	// make value_any holding a U constructed from args, analogous to make_value
+	template <typename U, typename... Args>
+	value_any make_value_any( Args&&... args ) {
+		value_any result;
+		result.template emplace<U>( std::forward<Args>( args )... );
+		return result;
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_ANY
@@ -0,0 +1,240 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+// Copy audit:  diagnostic mode reporting value_ptr deep copies which could have been moves
+//	enable by defining VALUE_PTR_AUDIT_COPIES for the whole program, before including value_ptr.hpp
+//	a sampled copy is flagged when its source is destroyed, moved from or reassigned before the pointee is next accessed
+//	tracking is per thread; a source used from another thread after the copy is not observed
+
+#ifndef SMART_PTR_VALUE_PTR_AUDIT
+#define SMART_PTR_VALUE_PTR_AUDIT
+
+#include <algorithm>	// std::sort
+#include <atomic>		// std::atomic
+#include <cstddef>		// std::size_t
+#include <cstdlib>		// std::free
+#include <map>			// std::map
+#include <mutex>		// std::mutex, std::lock_guard
+#include <ostream>		// std::ostream
+#include <vector>		// std::vector
+
+#if defined( __GLIBC__ ) || defined( __APPLE__ )
+#define VALUE_PTR_AUDIT_BACKTRACE 1
+#include <execinfo.h>	// backtrace, backtrace_symbols
+#else
+#define VALUE_PTR_AUDIT_BACKTRACE 0	// no stack capture; all copies are reported under one unknown call site
+#endif
+
+namespace smart_ptr {
+
+	// how the source of an audited copy ended
+	enum class copy_audit_outcome {
+		destroyed,		// destroyed without being read
+		moved_from,		// moved from without being read
+		reassigned,		// reset or assigned over without being read
+	};
+
+	// statistics for one copy call site
+	struct copy_audit_site {
+		std::vector<void*> frames;		// call stack of the copy, innermost first; empty if unavailable
+		std::size_t sampled = 0;		// sampled copies
+		std::size_t destroyed = 0;		// ... whose source was then destroyed without being read
+		std::size_t moved_from = 0;		// ... moved from without being read
+		std::size_t reassigned = 0;		// ... reset or assigned over without being read
+
+		// copies which could have been moves
+		std::size_t avoidable() const noexcept { return this->destroyed + this->moved_from + this->reassigned; }
+	};	// copy_audit_site
+
+	namespace detail {
+
+		constexpr std::size_t audit_max_frames = 16;
+		constexpr std::size_t audit_max_window = 64;
+
+		// copy whose source has not been read since
+		struct audit_pending {
+			const void* source;
+			void* frames[audit_max_frames];
+			std::size_t depth;
+		};
+
+		// pending copies of one thread, oldest first; trivially destructible so it remains usable during static destruction
+		struct audit_thread_state {
+			audit_pending entries[audit_max_window];
+			std::size_t count;
+			std::size_t countdown;	// copies until the next sample
+		};
+
+		inline audit_thread_state& audit_local() noexcept {
+			static thread_local audit_thread_state state;
+			return state;
+		}
+
+		// process-wide settings and per call site statistics; intentionally leaked, copies may be audited during static destruction
+		struct audit_registry {
+			std::atomic<std::size_t> sample_rate{ 1 };
+			std::atomic<std::size_t> window{ 16 };
+			std::mutex mutex;
+			std::map<std::vector<void*>, copy_audit_site> sites;
+
+			static audit_registry& instance() {
+				static audit_registry* registry = new audit_registry();
+				return *registry;
+			}
+
+			void record( void* const* frames, std::size_t depth, bool sampled, copy_audit_outcome* outcome ) {
+				std::vector<void*> key( frames, frames + depth );
+				std::lock_guard<std::mutex> lock( this->mutex );
+				copy_audit_site& site = this->sites[key];
+				if ( sampled )
+					++site.sampled;
+				if ( outcome ) {
+					switch ( *outcome ) {
+					case copy_audit_outcome::destroyed: ++site.destroyed; break;
+					case copy_audit_outcome::moved_from: ++site.moved_from; break;
+					case copy_audit_outcome::reassigned: ++site.reassigned; break;
+					}
+				}
+			}
+		};	// audit_registry
+
+		inline void audit_remove( audit_thread_state& state, std::size_t index ) noexcept {
+			for ( std::size_t i = index + 1; i < state.count; ++i )
+				state.entries[i - 1] = state.entries[i];
+			--state.count;
+		}
+
+		inline std::size_t audit_find( const audit_thread_state& state, const void* object ) noexcept {
+			for ( std::size_t i = state.count; i-- > 0; )
+				if ( state.entries[i].source == object )
+					return i;
+			return state.count;
+		}
+
+		// pointee of object accessed; a pending copy from it was necessary
+		inline void audit_read( const void* object ) noexcept {
+			audit_thread_state& state = audit_local();
+			if ( state.count == 0 )	// fast path
+				return;
+			const std::size_t index = audit_find( state, object );
+			if ( index != state.count )
+				audit_remove( state, index );
+		}
+
+		// object ended without its pointee being accessed; a pending copy from it was avoidable
+		inline void audit_end( const void* object, copy_audit_outcome outcome ) {
+			audit_thread_state& state = audit_local();
+			if ( state.count == 0 )	// fast path
+				return;
+			const std::size_t index = audit_find( state, object );
+			if ( index == state.count )
+				return;
+			const audit_pending& entry = state.entries[index];
+			audit_registry::instance().record( entry.frames, entry.depth, false, &outcome );
+			audit_remove( state, index );
+		}
+
+		// source is being copied
+		inline void audit_copy( const void* source ) {
+			audit_read( source );	// an earlier copy from source was necessary
+
+			audit_registry& registry = audit_registry::instance();
+			const std::size_t rate = registry.sample_rate.load( std::memory_order_relaxed );
+			audit_thread_state& state = audit_local();
+			if ( rate == 0 )
+				return;
+			if ( state.countdown == 0 || state.countdown > rate )	// sampled last time, or rate lowered
+				state.countdown = rate;
+			if ( --state.countdown != 0 )
+				return;
+
+			// pending copies outliving the window count as necessary
+			std::size_t window = registry.window.load( std::memory_order_relaxed );
+			window = window == 0 ? 1 : window > audit_max_window ? audit_max_window : window;
+			while ( state.count >= window )
+				audit_remove( state, 0 );
+
+			audit_pending& entry = state.entries[state.count];
+			entry.source = source;
+#if VALUE_PTR_AUDIT_BACKTRACE
+			void* frames[audit_max_frames + 1];
+			const int depth = ::backtrace( frames, static_cast<int>( audit_max_frames + 1 ) );
+			entry.depth = depth > 1 ? static_cast<std::size_t>( depth - 1 ) : 0;	// skip this function
+			std::copy( frames + 1, frames + 1 + entry.depth, entry.frames );
+#else
+			entry.depth = 0;
+#endif
+			++state.count;
+			registry.record( entry.frames, entry.depth, true, nullptr );
+		}
+
+	}	// detail
+
+	// copy audit settings and report; only records when VALUE_PTR_AUDIT_COPIES is defined
+	struct copy_audit {
+
+		// audit one in every n copies per thread; 1 audits every copy, 0 disables auditing
+		static void set_sample_rate( std::size_t n ) noexcept { detail::audit_registry::instance().sample_rate.store( n, std::memory_order_relaxed ); }
+		static std::size_t sample_rate() noexcept { return detail::audit_registry::instance().sample_rate.load( std::memory_order_relaxed ); }
+
+		// most recent pending copies tracked per thread, up to 64; older copies are assumed necessary
+		static void set_window( std::size_t n ) noexcept { detail::audit_registry::instance().window.store( n, std::memory_order_relaxed ); }
+		static std::size_t window() noexcept { return detail::audit_registry::instance().window.load( std::memory_order_relaxed ); }
+
+		// call sites ranked by avoidable copies, then by sampled copies
+		static std::vector<copy_audit_site> report() {
+			detail::audit_registry& registry = detail::audit_registry::instance();
+			std::vector<copy_audit_site> result;
+			{
+				std::lock_guard<std::mutex> lock( registry.mutex );
+				for ( const auto& site : registry.sites ) {
+					result.push_back( site.second );
+					result.back().frames = site.first;
+				}
+			}
+			std::sort( result.begin(), result.end(), []( const copy_audit_site& x, const copy_audit_site& y ) {
+				return x.avoidable() != y.avoidable() ? x.avoidable() > y.avoidable() : x.sampled > y.sampled;
+			} );
+			return result;
+		}
+
+		// write the top ranked call sites with symbolized stacks
+		static void print_report( std::ostream& os, std::size_t top = 10 ) {
+			const std::vector<copy_audit_site> sites = report();
+			os << "value_ptr copy audit (sample rate 1/" << sample_rate() << "): " << sites.size() << " call sites\n";
+			for ( std::size_t i = 0; i < sites.size() && i < top; ++i ) {
+				const copy_audit_site& site = sites[i];
+				os << "#" << ( i + 1 ) << "  avoidable " << site.avoidable() << " of " << site.sampled
+					<< " (destroyed " << site.destroyed << ", moved from " << site.moved_from << ", reassigned " << site.reassigned << ")\n";
+				if ( site.frames.empty() ) {
+					os << "    <unknown call site>\n";
+					continue;
+				}
+#if VALUE_PTR_AUDIT_BACKTRACE
+				char** symbols = ::backtrace_symbols( site.frames.data(), static_cast<int>( site.frames.size() ) );
+				for ( std::size_t f = 0; f < site.frames.size(); ++f ) {
+					if ( symbols )
+						os << "    " << symbols[f] << "\n";
+					else
+						os << "    " << site.frames[f] << "\n";
+				}
+				std::free( symbols );
+#endif
+			}
+		}
+
+		// discard statistics
+		static void clear() {
+			detail::audit_registry& registry = detail::audit_registry::instance();
+			std::lock_guard<std::mutex> lock( registry.mutex );
+			registry.sites.clear();
+		}
+	};	// copy_audit
+
+}	// smart_ptr ns
+
+#undef VALUE_PTR_AUDIT_BACKTRACE
+
+#endif // !SMART_PTR_VALUE_PTR_AUDIT
@@ -0,0 +1,133 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_BATCH
+#define SMART_PTR_VALUE_PTR_BATCH
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <cstddef>		// std::size_t
+#include <new>			// placement new
+#include <vector>		// std::vector
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// block shared by the objects made by one make_values call; freed with the last of them
+		struct batch_block {
+			std::atomic<std::size_t> refs;
+		};
+
+		// header in front of each object; block is null for objects allocated individually (copies)
+		struct batch_slot {
+			batch_block* block;
+		};
+
+		constexpr std::size_t batch_round_up( std::size_t size, std::size_t align ) { return ( ( size + align - 1 ) / align ) * align; }
+
+		// block layout:  [ batch_block | pad ] [ batch_slot | pad | T | pad ] * n
+		//	individual layout:  [ batch_slot | pad | T ]
+		template <typename T>
+		struct batch_layout {
+
+			static constexpr std::size_t align = alignof( T ) > alignof( batch_block ) ? alignof( T ) : alignof( batch_block );
+			static constexpr std::size_t offset = batch_round_up( sizeof( batch_slot ), alignof( T ) );	// object within a slot
+			static constexpr std::size_t stride = batch_round_up( offset + sizeof( T ), align );
+			static constexpr std::size_t block_header = batch_round_up( sizeof( batch_block ), align );
+
+			using allocation = aligned_allocation<align>;
+
+			static batch_slot* slot_of( const T* ptr ) noexcept { return reinterpret_cast<batch_slot*>( reinterpret_cast<char*>( const_cast<T*>( ptr ) ) - offset ); }
+			static T* object_of( char* slot ) noexcept { return reinterpret_cast<T*>( slot + offset ); }
+
+			static void release( batch_block* block ) noexcept {
+				if ( block->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+					block->~batch_block();
+					allocation::deallocate( block );
+				}
+			}
+
+			// copy constructed in an individual allocation
+			static T* copy( const T* what ) {
+				char* storage = static_cast<char*>( allocation::allocate( offset + sizeof( T ) ) );
+				try {
+					T* result = ::new( static_cast<void*>( object_of( storage ) ) ) T( *what );
+					::new( static_cast<void*>( storage ) ) batch_slot{ nullptr };
+					return result;
+				}
+				catch ( ... ) {
+					allocation::deallocate( storage );
+					throw;
+				}
+			}
+
+			static void destroy( T* ptr ) noexcept {
+				batch_slot* slot = slot_of( ptr );
+				batch_block* block = slot->block;
+				ptr->~T();
+				if ( block )
+					release( block );
+				else
+					allocation::deallocate( slot );
+			}
+		};	// batch_layout
+
+	}	// detail
+
+	// deleter for value_ptr_batched; destroys the object and releases its block, or frees an individually allocated copy
+	template <typename T>
+	struct batch_deleter {
+		void operator()( T* ptr ) const noexcept { detail::batch_layout<T>::destroy( ptr ); }
+	};	// batch_deleter
+
+	// copier for value_ptr_batched; copies are allocated individually, the block is never extended
+	template <typename T>
+	struct batch_copier {
+		T* operator()( const T* what ) const {
+			if ( !what )
+				return nullptr;
+			return detail::batch_layout<T>::copy( what );
+		}
+	};	// batch_copier
+
+	// value_ptr whose pointee may share one allocation with others made by the same make_values call; sizeof == sizeof(T*)
+	//	each element is independent:  copy, reset, move or destroy in any order; the block is freed with its last object
+	//	pointees must be created by make_values; reset(new T) or deleting a released pointer is undefined
+	template <typename T>
+	using value_ptr_batched = value_ptr<T, batch_deleter<T>, batch_copier<T>>;
+
+	// make n value_ptr_batched<T> from a single allocation, each constructed from copies of args, analogous to make_value
+	template <typename T, typename... Args>
+	std::vector<value_ptr_batched<T>> make_values( std::size_t n, const Args&... args ) {
+		using layout = detail::batch_layout<T>;
+
+		std::vector<value_ptr_batched<T>> result;
+		if ( n == 0 )
+			return result;
+		result.reserve( n );
+
+		char* storage = static_cast<char*>( layout::allocation::allocate( layout::block_header + n * layout::stride ) );
+		detail::batch_block* block = ::new( static_cast<void*>( storage ) ) detail::batch_block{ { 1 } };	// reference held while constructing
+
+		struct guard {
+			detail::batch_block* block;
+			~guard() { layout::release( this->block ); }
+		} g{ block };
+
+		for ( std::size_t i = 0; i < n; ++i ) {
+			char* slot = storage + layout::block_header + i * layout::stride;
+			T* object = ::new( static_cast<void*>( layout::object_of( slot ) ) ) T( args... );
+			::new( static_cast<void*>( slot ) ) detail::batch_slot{ block };
+			block->refs.fetch_add( 1, std::memory_order_relaxed );
+			result.emplace_back( object );
+		}
+		return result;
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_BATCH
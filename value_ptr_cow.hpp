@@ -0,0 +1,239 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_COW
+#define SMART_PTR_VALUE_PTR_COW
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <cstdint>		// std::uint64_t, std::uintptr_t
+#include <cstring>		// std::memcpy
+#include <new>			// std::bad_alloc, placement new
+
+#if defined( __linux__ )
+#define VALUE_PTR_COW_MMAP 1
+#include <fcntl.h>		// open
+#include <sys/mman.h>	// memfd_create, mmap, munmap
+#include <unistd.h>		// ftruncate, pread, close, sysconf
+#else
+#define VALUE_PTR_COW_MMAP 0	// no memfd; all objects use the default policies
+#endif
+
+namespace smart_ptr {
+
+	// default size at or above which pointees are placed in copy-on-write mappings
+	constexpr std::size_t cow_default_threshold = std::size_t( 1 ) << 20;
+
+	namespace detail {
+
+#if VALUE_PTR_COW_MMAP
+
+		// memfd holding the bytes of an object at creation; never written after creation, shared by all copies
+		struct cow_file {
+			std::atomic<std::size_t> refs{ 1 };
+			const int fd;
+
+			explicit cow_file( int fd_ ) : fd( fd_ ) {}
+			~cow_file() { ::close( this->fd ); }
+
+			void add_ref() noexcept { this->refs.fetch_add( 1, std::memory_order_relaxed ); }
+
+			void release() noexcept {
+				if ( this->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+					delete this;
+			}
+		};	// cow_file
+
+		// header at the start of each mapping; part of the file contents, so copies inherit it without writing
+		struct cow_header {
+			cow_file* file;
+		};
+
+		inline std::size_t cow_page_size() noexcept {
+			static const std::size_t size = static_cast<std::size_t>( ::sysconf( _SC_PAGESIZE ) );
+			return size;
+		}
+
+		// map file privately; writes are copy-on-write and never reach the file
+		inline char* cow_map_private( int fd, std::size_t length ) {
+			void* result = ::mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+			if ( result == MAP_FAILED )
+				throw std::bad_alloc();
+			return static_cast<char*>( result );
+		}
+
+		// descriptor of /proc/self/pagemap, opened once and kept for the life of the process; negative if unavailable
+		//	pread does not move a shared file offset, so the descriptor is safe to use from several threads
+		inline int cow_pagemap() noexcept {
+			static const int fd = ::open( "/proc/self/pagemap", O_RDONLY | O_CLOEXEC );
+			return fd;
+		}
+
+		// copy the pages of src which no longer match the file (privately written or swapped out) into dst
+		//	uses /proc/self/pagemap; copies everything if it is unavailable
+		inline void cow_copy_dirty( const char* src, char* dst, std::size_t length ) {
+			const std::size_t page = cow_page_size();
+			const int pagemap = cow_pagemap();
+			if ( pagemap < 0 ) {
+				std::memcpy( dst, src, length );
+				return;
+			}
+
+			const std::size_t first = reinterpret_cast<std::uintptr_t>( src ) / page;
+			const std::size_t pages = length / page;
+			std::uint64_t entries[512];
+
+			for ( std::size_t i = 0; i < pages; ) {
+				const std::size_t n = ( pages - i ) < 512 ? ( pages - i ) : 512;
+				const auto bytes = ::pread( pagemap, entries, n * sizeof( std::uint64_t ), static_cast<off_t>( ( first + i ) * sizeof( std::uint64_t ) ) );
+				if ( bytes != static_cast<ssize_t>( n * sizeof( std::uint64_t ) ) ) {
+					std::memcpy( dst + i * page, src + i * page, length - i * page );	// pagemap unreadable, copy the rest
+					break;
+				}
+				for ( std::size_t j = 0; j < n; ++j ) {
+					const bool present = ( entries[j] >> 63 ) & 1;
+					const bool swapped = ( entries[j] >> 62 ) & 1;
+					const bool file = ( entries[j] >> 61 ) & 1;
+					if ( ( present && !file ) || swapped )
+						std::memcpy( dst + ( i + j ) * page, src + ( i + j ) * page, page );
+				}
+				i += n;
+			}
+		}
+
+		// mapping layout:  [ cow_header | padding | T | padding to page size ]
+		template <typename T>
+		struct cow_layout {
+
+			static constexpr std::size_t offset = ( ( sizeof( cow_header ) + alignof( T ) - 1 ) / alignof( T ) ) * alignof( T );
+
+			static std::size_t length() noexcept {
+				const std::size_t page = cow_page_size();
+				return ( ( offset + sizeof( T ) + page - 1 ) / page ) * page;
+			}
+
+			static char* base_of( const T* ptr ) noexcept { return reinterpret_cast<char*>( const_cast<T*>( ptr ) ) - offset; }
+
+			// construct T in a fresh memfd through a shared mapping, then switch to a private mapping of the file
+			template <typename... Args>
+			static T* construct( Args&&... args ) {
+				const std::size_t len = length();
+				const int fd = ::memfd_create( "value_ptr_cow", MFD_CLOEXEC );
+				if ( fd < 0 )
+					throw std::bad_alloc();
+				cow_file* raw = nullptr;
+				try {
+					raw = new cow_file( fd );
+				}
+				catch ( ... ) {
+					::close( fd );
+					throw;
+				}
+				std::unique_ptr<cow_file, void( *)( cow_file* )> file( raw, []( cow_file* f ) { f->release(); } );
+
+				if ( ::ftruncate( fd, static_cast<off_t>( len ) ) != 0 )
+					throw std::bad_alloc();
+
+				void* shared = ::mmap( nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+				if ( shared == MAP_FAILED )
+					throw std::bad_alloc();
+				::new( shared ) cow_header{ file.get() };
+				try {
+					::new( static_cast<void*>( static_cast<char*>( shared ) + offset ) ) T( std::forward<Args>( args )... );	// trivially copyable, safe to relocate
+				}
+				catch ( ... ) {
+					::munmap( shared, len );
+					throw;
+				}
+				::munmap( shared, len );
+
+				char* base = cow_map_private( fd, len );
+				file.release();
+				return reinterpret_cast<T*>( base + offset );
+			}
+
+			// map the file again, then bring over the pages written since creation
+			static T* copy( const T* what ) {
+				const std::size_t len = length();
+				const char* src = base_of( what );
+				cow_file* file = reinterpret_cast<const cow_header*>( src )->file;
+
+				char* base = cow_map_private( file->fd, len );
+				file->add_ref();
+				cow_copy_dirty( src, base, len );
+				return reinterpret_cast<T*>( base + offset );
+			}
+
+			static void destroy( T* ptr ) noexcept {
+				char* base = base_of( ptr );
+				cow_file* file = reinterpret_cast<cow_header*>( base )->file;
+				::munmap( base, length() );
+				file->release();
+			}
+		};	// cow_layout
+
+#endif	// VALUE_PTR_COW_MMAP
+
+		// use mapping when T is at least Threshold bytes and memfd is available
+		template <typename T, std::size_t Threshold>
+		struct use_cow_mapping : std::integral_constant<bool, VALUE_PTR_COW_MMAP && sizeof( T ) >= Threshold> {};
+
+	}	// detail
+
+	// deleter for value_ptr_cow; unmaps large pointees, deletes small ones
+	template <typename T, std::size_t Threshold = cow_default_threshold>
+	struct cow_deleter {
+	private:
+#if VALUE_PTR_COW_MMAP
+		void operator()( T* ptr, std::true_type /*mapped*/ ) const noexcept { detail::cow_layout<T>::destroy( ptr ); }
+#endif
+		void operator()( T* ptr, std::false_type ) const noexcept { std::default_delete<T>()( ptr ); }
+	public:
+		void operator()( T* ptr ) const noexcept { this->operator()( ptr, detail::use_cow_mapping<T, Threshold>() ); }
+	};	// cow_deleter
+
+	// copier for value_ptr_cow; large pointees share unmodified pages with the source, small ones use default_copy
+	template <typename T, std::size_t Threshold = cow_default_threshold>
+	struct cow_copier {
+	private:
+#if VALUE_PTR_COW_MMAP
+		T* operator()( const T* what, std::true_type /*mapped*/ ) const { return detail::cow_layout<T>::copy( what ); }
+#endif
+		T* operator()( const T* what, std::false_type ) const { return detail::default_copy<T>()( what ); }
+	public:
+		T* operator()( const T* what ) const {
+			if ( !what )
+				return nullptr;
+			return this->operator()( what, detail::use_cow_mapping<T, Threshold>() );
+		}
+	};	// cow_copier
+
+	// value_ptr for large trivially copyable pointees; copies cost O(pages), and physical memory is only duplicated for pages later written
+	//	pointees must be created with make_value_cow; reset(new T) or deleting a released pointer is undefined
+	template <typename T, std::size_t Threshold = cow_default_threshold>
+	using value_ptr_cow = value_ptr<T, cow_deleter<T, Threshold>, cow_copier<T, Threshold>>;
+
+	namespace detail {
+#if VALUE_PTR_COW_MMAP
+		template <typename T, typename... Args>
+		T* make_cow( std::true_type /*mapped*/, Args&&... args ) { return cow_layout<T>::construct( std::forward<Args>( args )... ); }
+#endif
+		template <typename T, typename... Args>
+		T* make_cow( std::false_type, Args&&... args ) { return new T( std::forward<Args>( args )... ); }
+	}	// detail
+
+	// make value_ptr_cow, analogous to make_value
+	template <typename T, std::size_t Threshold = cow_default_threshold, typename... Args>
+	value_ptr_cow<T, Threshold> make_value_cow( Args&&... args ) {
+		static_assert( std::is_trivially_copyable<T>::value, "value_ptr_cow; T must be trivially copyable" );
+		return value_ptr_cow<T, Threshold>( detail::make_cow<T>( detail::use_cow_mapping<T, Threshold>(), std::forward<Args>( args )... ) );
+	}
+
+}	// smart_ptr ns
+
+#undef VALUE_PTR_COW_MMAP
+
+#endif // !SMART_PTR_VALUE_PTR_COW
@@ -0,0 +1,113 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_ERASED
+#define SMART_PTR_VALUE_PTR_ERASED
+
+#include "value_ptr.hpp"
+
+#include <typeinfo>		// typeid
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// copy/destroy routines for a U held through a T*
+		template <typename T>
+		struct erased_ops {
+			T* ( *copy )( const T* what );
+			void( *destroy )( T* what );
+			const void* tag;	// dynamic type tag of U
+		};	// erased_ops
+
+		// one shared record per (T, U); U's copy constructor and destructor are called directly, T needs no clone() or vtable
+		template <typename T, typename U>
+		struct erased_ops_for {
+			static T* copy( const T* what ) { return new U( static_cast<const U&>( *what ) ); }
+			static void destroy( T* what ) { delete static_cast<U*>( what ); }
+
+			static constexpr erased_ops<T> value{ &copy, &destroy, type_tag<U>() };
+		};	// erased_ops_for
+
+		template <typename T, typename U>
+		constexpr erased_ops<T> erased_ops_for<T, U>::value;
+
+		// default record; none for abstract T
+		template <typename T>
+		const erased_ops<T>* default_erased_ops( std::true_type /*abstract*/ ) noexcept { return nullptr; }
+
+		template <typename T>
+		const erased_ops<T>* default_erased_ops( std::false_type ) noexcept { return &erased_ops_for<T, T>::value; }
+
+	}	// detail
+
+	// deleter holding the copy/destroy record of the dynamic type captured at construction
+	template <typename T>
+	struct erased_delete {
+
+		const detail::erased_ops<T>* ops;
+
+		// record for T itself
+		erased_delete() noexcept
+			: ops( detail::default_erased_ops<T>( std::is_abstract<T>() ) )
+		{}
+
+		// record for U, a class derived from T (or T); called by value_ptr with the static type of the pointer at construction/reset
+		//	an abstract U keeps the current record
+		template <typename U>
+		erased_delete bind() const noexcept {
+			static_assert( std::is_same<T, U>::value || std::is_base_of<T, U>::value, "erased_delete; U must derive from T" );
+			return this->bind<U>( std::is_abstract<U>() );
+		}
+
+		// dynamic type tag of the pointee, for value_ptr::holds/get_as
+		const void* type_tag() const noexcept { return this->ops ? this->ops->tag : nullptr; }
+
+		void operator()( T* ptr ) const { this->ops->destroy( ptr ); }
+
+	private:
+		template <typename U>
+		erased_delete bind( std::true_type /*abstract*/ ) const noexcept { return *this; }
+
+		template <typename U>
+		erased_delete bind( std::false_type ) const noexcept {
+			erased_delete result;
+			result.ops = &detail::erased_ops_for<T, U>::value;
+			return result;
+		}
+	};	// erased_delete
+
+	// copier calling the copy routine recorded in erased_delete
+	template <typename T>
+	struct erased_copy {
+		T* operator()( const T* what, const erased_delete<T>& deleter ) const {
+			if ( !what )
+				return nullptr;
+			return deleter.ops->copy( what );
+		}
+	};	// erased_copy
+
+	// value_ptr copying its pointee through a per-dynamic-type record captured at construction, after polymorphic_value
+	//	no clone() or virtual destructor needed on T; sizeof == 2 * sizeof(T*)
+	//	the record is bound to the static type of the pointer passed at construction or reset(U*), which must be its dynamic type
+	template <typename T>
+	using value_ptr_erased = value_ptr<T, erased_delete<T>, erased_copy<T>>;
+
+	// make value_ptr_erased<T> holding a U, analogous to make_value
+	template <typename T, typename U = T, typename... Args>
+	value_ptr_erased<T> make_value_erased( Args&&... args ) {
+		return value_ptr_erased<T>( new U( std::forward<Args>( args )... ) );
+	}
+
+	// make value_ptr_erased<T> taking ownership of ptr; records ptr's static type U, which must be its dynamic type
+	template <typename T, typename U>
+	value_ptr_erased<T> make_value_erased_ptr( U* ptr ) {
+		assert( ( ptr == nullptr || !std::is_polymorphic<U>::value || typeid( *ptr ) == typeid( U ) ) && "make_value_erased_ptr; ptr's dynamic type would be sliced" );
+		return value_ptr_erased<T>( ptr );
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_ERASED
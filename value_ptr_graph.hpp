@@ -0,0 +1,256 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_GRAPH
+#define SMART_PTR_VALUE_PTR_GRAPH
+
+#include "value_ptr.hpp"
+
+#include <cstddef>		// std::ptrdiff_t
+#include <cstdint>		// std::uintptr_t, std::uint64_t
+#include <vector>		// std::vector
+
+namespace smart_ptr {
+
+	class clone_context;
+	template <typename T> struct graph_copy;
+
+	namespace detail {
+
+		// has clone(clone_context&) method detection
+		template<class T, class = void> struct has_context_clone : std::false_type {};
+		template<class T> struct has_context_clone<T, decltype(void(std::declval<const T&>().clone(std::declval<clone_context&>())))> : std::true_type {};
+
+		// address of the most derived object; pointers to any base subobject of one polymorphic object give the same memo key
+		template <typename T>
+		const void* graph_most_derived( const T* ptr, std::true_type /*polymorphic*/ ) noexcept { return dynamic_cast<const void*>( ptr ); }
+
+		template <typename T>
+		const void* graph_most_derived( const T* ptr, std::false_type ) noexcept { return ptr; }
+
+		template <typename T>
+		const void* graph_most_derived( const T* ptr ) noexcept { return graph_most_derived( ptr, std::is_polymorphic<T>() ); }
+
+		// open addressing (linear probing) map keyed by address; null key marks an empty slot
+		template <typename V>
+		class address_map {
+		public:
+			struct entry {
+				const void* key;
+				V value;
+			};
+
+			address_map() { this->rehash( 4 ); }
+
+			std::size_t size() const noexcept { return this->size_; }
+
+			// return entry for key, or nullptr
+			const entry* find( const void* key ) const noexcept {
+				for ( std::size_t i = this->slot( key );; i = ( i + 1 ) & this->mask() ) {
+					const entry& e = this->table_[i];
+					if ( e.key == key )
+						return &e;
+					if ( !e.key )
+						return nullptr;
+				}
+			}
+
+			// insert or overwrite value for key
+			void insert( const void* key, V value ) {
+				if ( ( this->size_ + 1 ) * 2 > this->table_.size() )	// max load factor 0.5
+					this->rehash( this->bits_ + 1 );
+				this->place( key, std::move( value ) );
+			}
+
+		private:
+			std::vector<entry> table_;
+			std::size_t size_ = 0;
+			unsigned bits_ = 0;
+
+			std::size_t mask() const noexcept { return this->table_.size() - 1; }
+
+			// fibonacci hashing; low address bits carry little information
+			std::size_t slot( const void* key ) const noexcept {
+				const std::uint64_t h = static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( key ) ) * 0x9E3779B97F4A7C15ull;
+				return static_cast<std::size_t>( h >> ( 64 - this->bits_ ) );
+			}
+
+			void place( const void* key, V value ) {
+				for ( std::size_t i = this->slot( key );; i = ( i + 1 ) & this->mask() ) {
+					entry& e = this->table_[i];
+					if ( !e.key ) {
+						e.key = key;
+						e.value = std::move( value );
+						++this->size_;
+						return;
+					}
+					if ( e.key == key ) {
+						e.value = std::move( value );
+						return;
+					}
+				}
+			}
+
+			void rehash( unsigned bits ) {
+				std::vector<entry> old( std::size_t( 1 ) << bits );
+				old.swap( this->table_ );
+				this->bits_ = bits;
+				this->size_ = 0;
+				for ( entry& e : old )
+					if ( e.key )
+						this->place( e.key, std::move( e.value ) );
+			}
+		};	// address_map
+
+	}	// detail
+
+	// memo of source to destination addresses for one graph clone
+	//	active for the duration of clone_graph; graph_copy and clone(clone_context&) hooks record into it,
+	//	copy constructors use it to remap observer pointers into the new graph
+	class clone_context {
+	public:
+		clone_context() = default;
+		clone_context( const clone_context& ) = delete;
+		clone_context& operator=( const clone_context& ) = delete;
+
+		// context of the clone_graph in progress on this thread, or nullptr
+		static clone_context* current() noexcept { return current_ref(); }
+
+		// return clone of source, or nullptr if not (yet) cloned
+		//	memo is keyed by the most derived object, so source may point to any base of a polymorphic object, primary or not
+		//	a non-polymorphic source must have the static type the object was cloned through
+		template <typename T>
+		T* find( const T* source ) const noexcept {
+			if ( !source )
+				return nullptr;
+			const void* key = detail::graph_most_derived( source );
+			const auto e = this->clones_.find( key );
+			if ( !e )
+				return nullptr;
+			// the clone has the source's dynamic type, so the T subobject lies at the same offset
+			const std::ptrdiff_t offset = reinterpret_cast<const char*>( source ) - static_cast<const char*>( key );
+			return reinterpret_cast<T*>( static_cast<char*>( e->value ) + offset );
+		}
+
+		// record clone of source
+		template <typename T>
+		void record( const T* source, T* clone ) { this->clones_.insert( detail::graph_most_derived( source ), const_cast<void*>( detail::graph_most_derived( clone ) ) ); }
+
+		// return clone of observed object, or the observed object itself if it lies outside the cloned graph
+		template <typename T>
+		T* remap( T* source ) const noexcept {
+			T* clone = this->find( source );
+			return clone ? clone : source;
+		}
+
+		// remap observer slot; deferred until the whole graph is cloned if source has not been cloned yet
+		//	a deferred remap writes through &slot when clone_graph finishes, so slot must keep its address until then:
+		//	remap into pre-sized storage, not e.g. into observers.back() of a vector that may still reallocate
+		template <typename T>
+		void remap( T*& slot, T* source ) {
+			slot = source;
+			if ( T* clone = this->find( source ) )
+				slot = clone;
+			else
+				this->fixups_.push_back( { &slot, source, &apply_fixup<T> } );
+		}
+
+		// clone a shared sub-object exactly once per graph
+		template <typename T>
+		std::shared_ptr<T> clone_shared( const std::shared_ptr<T>& source ) {
+			if ( !source )
+				return nullptr;
+			if ( const auto e = this->shared_.find( source.get() ) )
+				return std::static_pointer_cast<T>( e->value );
+			const std::shared_ptr<T> result( graph_copy<T>()( source.get() ) );
+			this->shared_.insert( source.get(), result );
+			return result;
+		}
+
+		// number of distinct objects cloned
+		std::size_t size() const noexcept { return this->clones_.size(); }
+
+		// activates a context on this thread; restores the previous context on exit
+		struct scope {
+			clone_context* previous;
+
+			explicit scope( clone_context& ctx ) noexcept
+				: previous( current_ref() )
+			{
+				current_ref() = &ctx;
+			}
+
+			scope( const scope& ) = delete;
+			scope& operator=( const scope& ) = delete;
+
+			~scope() { current_ref() = this->previous; }
+		};	// scope
+
+		// apply deferred observer remaps
+		void finish() {
+			for ( const fixup& f : this->fixups_ )
+				f.apply( *this, f.slot, f.source );
+			this->fixups_.clear();
+		}
+
+	private:
+		struct fixup {
+			void* slot;
+			const void* source;
+			void( *apply )( const clone_context&, void*, const void* );
+		};
+
+		detail::address_map<void*> clones_;
+		detail::address_map<std::shared_ptr<void>> shared_;
+		std::vector<fixup> fixups_;
+
+		template <typename T>
+		static void apply_fixup( const clone_context& ctx, void* slot, const void* source ) {
+			*static_cast<T**>( slot ) = ctx.remap( static_cast<T*>( const_cast<void*>( source ) ) );
+		}
+
+		static clone_context*& current_ref() noexcept {
+			static thread_local clone_context* ctx = nullptr;
+			return ctx;
+		}
+	};	// clone_context
+
+	// graph-aware copier; records each clone in the active clone_context, and prefers a clone(clone_context&) member
+	//	behaves as default_copy outside of clone_graph
+	template <typename T>
+	struct graph_copy {
+	private:
+		T* operator()( const T* what, clone_context& ctx, std::true_type /*has_context_clone*/ ) const { return what->clone( ctx ); }
+		T* operator()( const T* what, clone_context&, std::false_type ) const { return detail::default_copy<T>()( what ); }
+	public:
+		T* operator()( const T* what ) const {
+			clone_context* ctx = clone_context::current();
+			if ( !what || !ctx )
+				return detail::default_copy<T>()( what );
+
+			T* result = this->operator()( what, *ctx, detail::has_context_clone<T>() );
+			ctx->record( what, result );
+			return result;
+		}
+	};	// graph_copy
+
+	// value_ptr participating in graph clones
+	template <typename T, typename Deleter = std::default_delete<T>>
+	using value_ptr_graph = value_ptr<T, Deleter, graph_copy<T>>;
+
+	// copy root and everything reachable from it, remapping observers into the new graph
+	//	the result is returned by move (or elided); the context ends when this function returns
+	template <typename T>
+	T clone_graph( const T& root ) {
+		clone_context ctx;
+		clone_context::scope active( ctx );
+		T result( root );
+		ctx.finish();
+		return result;
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_GRAPH
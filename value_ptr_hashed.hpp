@@ -0,0 +1,135 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_HASHED
+#define SMART_PTR_VALUE_PTR_HASHED
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+
+namespace smart_ptr {
+
+	// value_ptr with value comparison and a cached hash of the pointee, for use as a container key
+	//	the hash is computed on first use and invalidated by any non-const access
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::default_copy<T>
+	>
+	struct value_ptr_hashed {
+
+		using value_ptr_type = value_ptr<T, Deleter, Copier>;
+		using element_type = T;
+		using pointer = typename value_ptr_type::pointer;
+
+		// construct with pointer
+		template <typename Px, typename = typename std::enable_if<std::is_convertible<Px, pointer>::value>::type>
+		value_ptr_hashed( Px px )
+			: ptr_( std::forward<Px>( px ) )
+		{}
+
+		// construct from value_ptr
+		value_ptr_hashed( value_ptr_type ptr = nullptr )
+			: ptr_( std::move( ptr ) )
+		{}
+
+		value_ptr_hashed( const value_ptr_hashed& that )
+			: ptr_( that.ptr_ )
+			, hash_( that.hash_.load( std::memory_order_relaxed ) )	// copy has the same value, keep the hash
+		{}
+
+		value_ptr_hashed( value_ptr_hashed&& that ) noexcept
+			: ptr_( std::move( that.ptr_ ) )
+			, hash_( that.hash_.exchange( 0, std::memory_order_relaxed ) )
+		{}
+
+		value_ptr_hashed& operator=( const value_ptr_hashed& that ) {
+			this->ptr_ = that.ptr_;
+			this->hash_.store( that.hash_.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+			return *this;
+		}
+
+		value_ptr_hashed& operator=( value_ptr_hashed&& that ) noexcept {
+			this->ptr_ = std::move( that.ptr_ );
+			this->hash_.store( that.hash_.exchange( 0, std::memory_order_relaxed ), std::memory_order_relaxed );
+			return *this;
+		}
+
+		// return underlying value_ptr
+		const value_ptr_type& ptr() const noexcept { return this->ptr_; }
+
+		// return underlying value_ptr; invalidates hash
+		value_ptr_type& ptr() noexcept { this->invalidate(); return this->ptr_; }
+
+		// get pointer
+		const T* get() const noexcept { return this->ptr_.get(); }
+
+		// get pointer; invalidates hash
+		pointer get() noexcept { this->invalidate(); return this->ptr_.get(); }
+
+		const T& operator*() const noexcept { return *this->get(); }
+		T& operator*() noexcept { return *this->get(); }
+
+		const T* operator->() const noexcept { return this->get(); }
+		pointer operator->() noexcept { return this->get(); }
+
+		// return flag if has pointer
+		explicit operator bool() const noexcept { return (bool)this->ptr_; }
+
+		// reset pointer
+		template <typename... Args>
+		void reset( Args&&... args ) {
+			this->invalidate();
+			this->ptr_.reset( std::forward<Args>( args )... );
+		}
+
+		// return cached hash of pointee, computing it if needed
+		std::size_t hash() const {
+			std::size_t result = this->hash_.load( std::memory_order_relaxed );
+			if ( result == 0 ) {
+				result = deep_hash()( this->ptr_ );
+				if ( result == 0 )	// 0 is reserved for 'not computed'
+					result = 1;
+				this->hash_.store( result, std::memory_order_relaxed );
+			}
+			return result;
+		}
+
+		// discard cached hash; needed after mutating the pointee through a pointer obtained earlier
+		void invalidate() noexcept { this->hash_.store( 0, std::memory_order_relaxed ); }
+
+		// swap with other value_ptr_hashed
+		void swap( value_ptr_hashed& that ) { std::swap( *this, that ); }
+
+	private:
+		value_ptr_type ptr_;
+		mutable std::atomic<std::size_t> hash_{ 0 };
+	};	// value_ptr_hashed
+
+	// value comparison; cached hashes short-circuit unequal values
+	template <class T, class D, class C>
+	bool operator == ( const value_ptr_hashed<T, D, C>& x, const value_ptr_hashed<T, D, C>& y ) {
+		return x.hash() == y.hash() && deep_equal()( x, y );
+	}
+
+	template <class T, class D, class C>
+	bool operator != ( const value_ptr_hashed<T, D, C>& x, const value_ptr_hashed<T, D, C>& y ) { return !( x == y ); }
+
+	template <class T, class D, class C>
+	bool operator < ( const value_ptr_hashed<T, D, C>& x, const value_ptr_hashed<T, D, C>& y ) { return deep_less()( x, y ); }
+
+	template <class T, class D, class C>
+	void swap( value_ptr_hashed<T, D, C>& x, value_ptr_hashed<T, D, C>& y ) { x.swap( y ); }
+
+}	// smart_ptr ns
+
+namespace std {
+	template <class T, class D, class C>
+	struct hash<smart_ptr::value_ptr_hashed<T, D, C>> {
+		std::size_t operator()( const smart_ptr::value_ptr_hashed<T, D, C>& p ) const { return p.hash(); }
+	};
+}	// std ns
+
+#endif // !SMART_PTR_VALUE_PTR_HASHED
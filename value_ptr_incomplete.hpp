@@ -9,6 +9,9 @@
 
 #include "value_ptr.hpp"
 
+#include <cstddef>		// std::size_t, std::max_align_t
+#include <new>			// placement new
+
 namespace smart_ptr {
 
 	namespace detail {
@@ -46,6 +49,29 @@ namespace smart_ptr {
 
 		};	// functor_wrapper
 
+		// type-erased destroy/copy/move for an object held in inline storage
+		//	like functor_wrapper's delegate, captured where the (previously incomplete) type is complete
+		struct inline_ops {
+			void( *destroy )( void* what );
+			void( *copy )( void* where, const void* what );
+			void( *move )( void* where, void* what );	// move construct at where, then destroy what
+		};	// inline_ops
+
+		template <typename T>
+		struct inline_ops_for {
+			static void destroy( void* what ) { static_cast<T*>( what )->~T(); }
+			static void copy( void* where, const void* what ) { ::new( where ) T( *static_cast<const T*>( what ) ); }
+			static void move( void* where, void* what ) {
+				::new( where ) T( std::move( *static_cast<T*>( what ) ) );
+				destroy( what );
+			}
+
+			static constexpr inline_ops value{ &destroy, &copy, &move };
+		};	// inline_ops_for
+
+		template <typename T>
+		constexpr inline_ops inline_ops_for<T>::value;
+
 	}	// detail
 
 	template <typename T
@@ -102,6 +128,123 @@ namespace smart_ptr {
 
 	};	// value_ptr_incomplete
 
+	// fast PIMPL:  holds a (potentially) incomplete type in inline storage of declared Size and Align, no heap allocation
+	//	Size and Align are checked against T where emplace is called, i.e. in the TU where T is complete
+	//	sizeof( value_ptr_incomplete_inline<T, Size, Align> ) == Size (rounded up to Align) + one pointer
+	template <typename T
+		, std::size_t Size
+		, std::size_t Align = alignof( std::max_align_t )
+	>
+		class value_ptr_incomplete_inline
+	{
+	public:
+		using element_type = T;
+		using pointer = T*;
+		using reference = T&;
+
+		// default construct for incomplete type; empty
+		value_ptr_incomplete_inline( std::nullptr_t = nullptr ) noexcept
+			: storage_()
+			, ops_( nullptr )
+		{}
+
+		value_ptr_incomplete_inline( const value_ptr_incomplete_inline& that )
+			: value_ptr_incomplete_inline()
+		{
+			this->assign( that );
+		}
+
+		value_ptr_incomplete_inline( value_ptr_incomplete_inline&& that )
+			: value_ptr_incomplete_inline()
+		{
+			this->assign( std::move( that ) );
+		}
+
+		value_ptr_incomplete_inline& operator=( const value_ptr_incomplete_inline& that ) {
+			if ( this != &that ) {
+				this->reset();
+				this->assign( that );
+			}
+			return *this;
+		}
+
+		value_ptr_incomplete_inline& operator=( value_ptr_incomplete_inline&& that ) {
+			if ( this != &that ) {
+				this->reset();
+				this->assign( std::move( that ) );
+			}
+			return *this;
+		}
+
+		value_ptr_incomplete_inline& operator=( std::nullptr_t ) noexcept {
+			this->reset();
+			return *this;
+		}
+
+		~value_ptr_incomplete_inline() { this->reset(); }
+
+		// construct T in place; T must be complete here
+		template <typename... Args>
+		T& emplace( Args&&... args ) {
+			static_assert( sizeof( T ) <= Size, "value_ptr_incomplete_inline; declared Size is too small for T" );
+			static_assert( Align % alignof( T ) == 0, "value_ptr_incomplete_inline; declared Align is insufficient for T" );
+
+			this->reset();
+			T* result = ::new( static_cast<void*>( &this->storage_ ) ) T( std::forward<Args>( args )... );
+			this->ops_ = &detail::inline_ops_for<T>::value;
+			return *result;
+		}
+
+		// destroy held object
+		void reset() noexcept {
+			if ( this->ops_ )
+				this->ops_->destroy( &this->storage_ );
+			this->ops_ = nullptr;
+		}
+
+		// get pointer
+		pointer get() const noexcept { return this->ops_ ? reinterpret_cast<T*>( const_cast<unsigned char*>( this->storage_ ) ) : nullptr; }
+
+		// return flag if has object
+		explicit operator bool() const noexcept { return this->ops_ != nullptr; }
+
+		// return reference to T, UB if null
+		reference operator*() const noexcept { return *this->get(); }
+
+		// return pointer to T
+		pointer operator-> () const noexcept { return this->get(); }
+
+		// swap with other value_ptr_incomplete_inline
+		void swap( value_ptr_incomplete_inline& that ) {
+			value_ptr_incomplete_inline temp( std::move( that ) );
+			that = std::move( *this );
+			*this = std::move( temp );
+		}
+
+	private:
+		alignas( Align ) unsigned char storage_[Size];
+		const detail::inline_ops* ops_;
+
+		void assign( const value_ptr_incomplete_inline& that ) {
+			if ( that.ops_ ) {
+				that.ops_->copy( &this->storage_, &that.storage_ );
+				this->ops_ = that.ops_;
+			}
+		}
+
+		void assign( value_ptr_incomplete_inline&& that ) {
+			if ( that.ops_ ) {
+				that.ops_->move( &this->storage_, &that.storage_ );
+				this->ops_ = that.ops_;
+				that.ops_ = nullptr;
+			}
+		}
+
+	};	// value_ptr_incomplete_inline
+
+	template <class T, std::size_t S, std::size_t A>
+	void swap( value_ptr_incomplete_inline<T, S, A>& x, value_ptr_incomplete_inline<T, S, A>& y ) { x.swap( y ); }
+
 }	// smart_ptr ns
 
 #endif // !SMART_PTR_VALUE_PTR_INCOMPLETE
@@ -0,0 +1,213 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_INDIRECT
+#define SMART_PTR_VALUE_PTR_INDIRECT
+
+#include "value_ptr.hpp"
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// copier without null check, for holders which are never null when copied
+		//	copies via copy constructor, never clone(); analogous to default_copy for non-polymorphic types
+		template <typename T>
+		struct indirect_copy {
+			T* operator()( const T* what ) const {
+				assert( what != nullptr && "indirect; copy of valueless object" );
+				return new T( *what );
+			}
+		};	// indirect_copy
+
+		// copier without null check, for holders which are never null when copied
+		//	uses clone() if detected, as default_copy
+		template <typename T>
+		struct polymorphic_copy {
+		private:
+			struct _clone_tag {};
+			struct _copy_tag {};
+			T* operator()( const T* what, _clone_tag ) const { return what->clone(); }
+			T* operator()( const T* what, _copy_tag ) const { return new T( *what ); }
+		public:
+			T* operator()( const T* what ) const {
+				assert( what != nullptr && "polymorphic; copy of valueless object" );
+				return this->operator()( what, typename std::conditional<detail::has_clone<T>::value, _clone_tag, _copy_tag>::type() );
+			}
+		};	// polymorphic_copy
+
+		// Copier adapted to the null checks of value_ptr, for conversions from a holder with a custom copier
+		template <typename T, typename Copier>
+		struct nullable_copy : Copier {
+			nullable_copy() = default;
+
+			nullable_copy( const Copier& cx )
+				: Copier( cx )
+			{}
+
+			T* operator()( const T* what ) const { return what ? Copier::operator()( what ) : nullptr; }
+		};	// nullable_copy
+
+		// copier of the value_ptr an indirect/polymorphic converts to; default_copy copies as the built-in copiers do, a custom copier is kept
+		template <typename T, typename Copier>
+		struct indirect_value_copier {
+			using type = nullable_copy<T, Copier>;
+			static type make( const Copier& cx ) { return type( cx ); }
+		};
+
+		template <typename T>
+		struct indirect_value_copier<T, indirect_copy<T>> {
+			using type = default_copy<T>;
+			static type make( const indirect_copy<T>& ) { return type(); }
+		};
+
+		template <typename T>
+		struct indirect_value_copier<T, polymorphic_copy<T>> {
+			using type = default_copy<T>;
+			static type make( const polymorphic_copy<T>& ) { return type(); }
+		};
+
+		// common implementation of indirect and polymorphic; never null outside of a moved-from state
+		//	shares value_ptr's ptr_data layout, sizeof == sizeof(T*) for stateless policies
+		template <typename T, typename Deleter, typename Copier>
+		class indirect_base {
+		public:
+			using value_type = T;
+			using deleter_type = Deleter;
+			using copier_type = Copier;
+			using pointer = typename ptr_data<T, Deleter, Copier>::pointer;
+			using const_pointer = const T*;
+
+			// return reference to T; UB if valueless
+			T& operator*() noexcept { return *this->_data.get(); }
+			const T& operator*() const noexcept { return *this->_data.get(); }
+
+			// return pointer to T; const propagates to the pointee
+			pointer operator->() noexcept { return this->_data.get(); }
+			const_pointer operator->() const noexcept { return this->_data.get(); }
+
+			// true only after being moved from
+			bool valueless_after_move() const noexcept { return !this->_data.uptr; }
+
+			deleter_type& get_deleter() noexcept { return this->_data.uptr.get_deleter(); }
+			const deleter_type& get_deleter() const noexcept { return this->_data.uptr.get_deleter(); }
+
+			copier_type& get_copier() noexcept { return this->_data.get_copier(); }
+			const copier_type& get_copier() const noexcept { return this->_data.get_copier(); }
+
+			// value_ptr this converts to; value_ptr<T, Deleter> for the default copiers, otherwise keeps Copier so copies never slice
+			using value_ptr_type = value_ptr<T, Deleter, typename indirect_value_copier<T, Copier>::type>;
+
+			// explicit conversion to value_ptr, deep copy
+			explicit operator value_ptr_type() const & {
+				return value_ptr_type( this->get_copier()( this->_data.get() ), this->get_deleter(), indirect_value_copier<T, Copier>::make( this->get_copier() ) );
+			}
+
+			// explicit conversion to value_ptr, transfers ownership; this becomes valueless
+			explicit operator value_ptr_type() && {
+				auto cx = indirect_value_copier<T, Copier>::make( this->get_copier() );
+				return value_ptr_type( this->_data.release(), std::move( this->get_deleter() ), std::move( cx ) );
+			}
+
+		protected:
+			ptr_data<T, Deleter, Copier> _data;
+
+			indirect_base( T* px, Deleter dx, Copier cx )
+				: _data( px, std::move( dx ), std::move( cx ) )
+			{
+				assert( px != nullptr );
+			}
+
+			void swap_data( indirect_base& that ) { std::swap( this->_data, that._data ); }
+		};	// indirect_base
+
+	}	// detail
+
+	// deep-copying, non-nullable holder for a single (non-polymorphic) T, after P3019 indirect
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::indirect_copy<T>
+	>
+	class indirect : public detail::indirect_base<T, Deleter, Copier> {
+		using base_type = detail::indirect_base<T, Deleter, Copier>;
+	public:
+		// value initialized T
+		indirect()
+			: base_type( new T(), Deleter(), Copier() )
+		{}
+
+		explicit indirect( const T& value )
+			: base_type( new T( value ), Deleter(), Copier() )
+		{}
+
+		explicit indirect( T&& value )
+			: base_type( new T( std::move( value ) ), Deleter(), Copier() )
+		{}
+
+		// take ownership of value_ptr's pointee; value_ptr must not be null
+		template <typename C>
+		explicit indirect( value_ptr<T, Deleter, C>&& ptr, Copier cx = {} )
+			: base_type( ptr.get(), std::move( ptr.get_deleter() ), std::move( cx ) )
+		{
+			ptr.release();
+		}
+
+		void swap( indirect& that ) { this->swap_data( that ); }
+	};	// indirect
+
+	// deep-copying, non-nullable holder for T or a class derived from T, after P3019 polymorphic
+	//	copies use clone() when detected, as value_ptr; slicing is rejected at compile time
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::polymorphic_copy<T>
+	>
+	class polymorphic : public detail::indirect_base<T, Deleter, Copier> {
+		using base_type = detail::indirect_base<T, Deleter, Copier>;
+	public:
+		// value initialized T
+		polymorphic()
+			: base_type( new T(), Deleter(), Copier() )
+		{}
+
+		// take ownership of px; must not be null
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		explicit polymorphic( U* px, Deleter dx = {}, Copier cx = {} )
+			: base_type( px, std::move( dx ), std::move( cx ) )
+		{
+			static_assert(
+				detail::slice_test<T*, U*, std::is_convertible<detail::polymorphic_copy<T>, Copier>::value>::value
+				, "polymorphic; clone() method not detected and not using custom copier; slicing may occur"
+				);
+		}
+
+		// take ownership of value_ptr's pointee; value_ptr must not be null
+		template <typename C>
+		explicit polymorphic( value_ptr<T, Deleter, C>&& ptr, Copier cx = {} )
+			: base_type( ptr.get(), std::move( ptr.get_deleter() ), std::move( cx ) )
+		{
+			ptr.release();
+		}
+
+		void swap( polymorphic& that ) { this->swap_data( that ); }
+	};	// polymorphic
+
+	template <class T, class D, class C> void swap( indirect<T, D, C>& x, indirect<T, D, C>& y ) { x.swap( y ); }
+	template <class T, class D, class C> void swap( polymorphic<T, D, C>& x, polymorphic<T, D, C>& y ) { x.swap( y ); }
+
+	// make indirect<T>, analogous to make_value
+	template <typename T, typename... Args>
+	indirect<T> make_indirect( Args&&... args ) {
+		return indirect<T>( make_value<T>( std::forward<Args>( args )... ) );
+	}
+
+	// make polymorphic<T> holding a U, analogous to make_value
+	template <typename T, typename U = T, typename... Args>
+	polymorphic<T> make_polymorphic( Args&&... args ) {
+		return polymorphic<T>( new U( std::forward<Args>( args )... ) );
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_INDIRECT
@@ -0,0 +1,227 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_INTERNED
+#define SMART_PTR_VALUE_PTR_INTERNED
+
+#include "value_ptr.hpp"
+
+#include <atomic>			// std::atomic
+#include <mutex>			// std::mutex, std::lock_guard
+#include <unordered_map>	// std::unordered_multimap
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// canonical instance of an interned value
+		template <typename T, typename Deleter>
+		struct intern_node {
+			std::atomic<std::size_t> refs{ 1 };
+			const std::size_t hash;
+			const std::unique_ptr<T, Deleter> value;
+
+			intern_node( std::size_t hash_, T* value_ )
+				: hash( hash_ )
+				, value( value_ )
+			{}
+		};	// intern_node
+
+		// sharded table of canonical instances; entries are evicted when their last reference is released
+		//	refcount protocol:  lookups increment under the shard lock, and the 1 -> 0 transition only happens under the shard lock
+		template <typename T, typename Hash, typename KeyEqual, typename Deleter, typename Copier>
+		class intern_table {
+		public:
+			using node_type = intern_node<T, Deleter>;
+
+			// leaked intentionally; interned values held by other statics may outlive static destruction
+			static intern_table& instance() {
+				static intern_table* table = new intern_table();
+				return *table;
+			}
+
+			// return canonical node for value, creating it with Copier if needed
+			node_type* intern( const T& value ) {
+				const std::size_t hash = Hash()( value );
+				shard& s = this->shard_of( hash );
+				std::lock_guard<std::mutex> lock( s.mutex );
+
+				const auto range = s.nodes.equal_range( hash );
+				for ( auto it = range.first; it != range.second; ++it ) {
+					if ( KeyEqual()( *it->second->value, value ) ) {
+						it->second->refs.fetch_add( 1, std::memory_order_relaxed );
+						return it->second;
+					}
+				}
+
+				std::unique_ptr<node_type> node( new node_type( hash, Copier()( &value ) ) );
+				s.nodes.emplace( hash, node.get() );
+				return node.release();
+			}
+
+			// drop a reference, evicting the node when it was the last one
+			void release( node_type* node ) noexcept {
+				std::size_t refs = node->refs.load( std::memory_order_relaxed );
+				while ( refs > 1 )	// fast path, cannot reach zero
+					if ( node->refs.compare_exchange_weak( refs, refs - 1, std::memory_order_release, std::memory_order_relaxed ) )
+						return;
+
+				shard& s = this->shard_of( node->hash );
+				{
+					std::lock_guard<std::mutex> lock( s.mutex );
+					if ( node->refs.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+						return;
+
+					const auto range = s.nodes.equal_range( node->hash );
+					for ( auto it = range.first; it != range.second; ++it ) {
+						if ( it->second == node ) {
+							s.nodes.erase( it );
+							break;
+						}
+					}
+				}
+				delete node;
+			}
+
+			// number of distinct values currently interned
+			std::size_t size() {
+				std::size_t result = 0;
+				for ( shard& s : this->shards_ ) {
+					std::lock_guard<std::mutex> lock( s.mutex );
+					result += s.nodes.size();
+				}
+				return result;
+			}
+
+		private:
+			static constexpr std::size_t shard_count = 16;
+
+			struct shard {
+				std::mutex mutex;
+				std::unordered_multimap<std::size_t, node_type*> nodes;
+			};
+
+			shard shards_[shard_count];
+
+			intern_table() = default;
+
+			shard& shard_of( std::size_t hash ) noexcept { return this->shards_[( hash ^ ( hash >> 16 ) ) % shard_count]; }
+		};	// intern_table
+
+	}	// detail
+
+	// refcounted handle to an immutable, hash-consed value; equal values share one allocation
+	//	equality is a pointer comparison; the canonical instance is created with Copier (clone() aware, as value_ptr)
+	template <typename T
+		, typename Hash = std::hash<T>
+		, typename KeyEqual = std::equal_to<T>
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::default_copy<T>
+	>
+	class interned_value_ptr {
+	public:
+		using element_type = const T;
+		using pointer = const T*;
+		using reference = const T&;
+		using table_type = detail::intern_table<T, Hash, KeyEqual, Deleter, Copier>;
+
+		// std::nullptr_t, default ctor
+		interned_value_ptr( std::nullptr_t = nullptr ) noexcept
+		{}
+
+		// intern value
+		explicit interned_value_ptr( const T& value )
+			: node_( table_type::instance().intern( value ) )
+		{}
+
+		// intern pointee of value_ptr
+		template <typename D, typename C>
+		explicit interned_value_ptr( const value_ptr<T, D, C>& ptr )
+			: node_( ptr ? table_type::instance().intern( *ptr ) : nullptr )
+		{}
+
+		// copy shares the canonical instance; no lookup needed
+		interned_value_ptr( const interned_value_ptr& that ) noexcept
+			: node_( that.node_ )
+		{
+			if ( this->node_ )
+				this->node_->refs.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		interned_value_ptr( interned_value_ptr&& that ) noexcept
+			: node_( that.node_ )
+		{
+			that.node_ = nullptr;
+		}
+
+		interned_value_ptr& operator=( interned_value_ptr that ) noexcept {
+			this->swap( that );
+			return *this;
+		}
+
+		~interned_value_ptr() { this->reset(); }
+
+		// get pointer
+		pointer get() const noexcept { return this->node_ ? this->node_->value.get() : nullptr; }
+
+		// return reference to T, UB if null
+		reference operator*() const noexcept { return *this->get(); }
+
+		pointer operator->() const noexcept { return this->get(); }
+
+		explicit operator bool() const noexcept { return this->node_ != nullptr; }
+
+		// number of handles sharing the canonical instance
+		std::size_t use_count() const noexcept { return this->node_ ? this->node_->refs.load( std::memory_order_relaxed ) : 0; }
+
+		// cached hash of the value, 0 if null
+		std::size_t hash() const noexcept { return this->node_ ? this->node_->hash : 0; }
+
+		// release reference
+		void reset() noexcept {
+			if ( this->node_ )
+				table_type::instance().release( this->node_ );
+			this->node_ = nullptr;
+		}
+
+		void swap( interned_value_ptr& that ) noexcept { std::swap( this->node_, that.node_ ); }
+
+		// mutable, independent deep copy
+		value_ptr<T, Deleter, Copier> to_value_ptr() const {
+			return value_ptr<T, Deleter, Copier>( this->node_ ? Copier()( this->get() ) : nullptr );
+		}
+
+		// number of distinct values currently interned for this type
+		static std::size_t interned_count() { return table_type::instance().size(); }
+
+	private:
+		typename table_type::node_type* node_ = nullptr;
+	};	// interned_value_ptr
+
+	// make interned_value_ptr, analogous to make_value
+	template <typename T, typename... Args>
+	interned_value_ptr<T> make_interned( Args&&... args ) {
+		return interned_value_ptr<T>( T( std::forward<Args>( args )... ) );
+	}
+
+	template <class T, class H, class K, class D, class C>
+	bool operator == ( const interned_value_ptr<T, H, K, D, C>& x, const interned_value_ptr<T, H, K, D, C>& y ) noexcept { return x.get() == y.get(); }
+
+	template <class T, class H, class K, class D, class C>
+	bool operator != ( const interned_value_ptr<T, H, K, D, C>& x, const interned_value_ptr<T, H, K, D, C>& y ) noexcept { return x.get() != y.get(); }
+
+	template <class T, class H, class K, class D, class C>
+	void swap( interned_value_ptr<T, H, K, D, C>& x, interned_value_ptr<T, H, K, D, C>& y ) noexcept { x.swap( y ); }
+
+}	// smart_ptr ns
+
+namespace std {
+	template <class T, class H, class K, class D, class C>
+	struct hash<smart_ptr::interned_value_ptr<T, H, K, D, C>> {
+		std::size_t operator()( const smart_ptr::interned_value_ptr<T, H, K, D, C>& p ) const noexcept { return p.hash(); }
+	};
+}	// std ns
+
+#endif // !SMART_PTR_VALUE_PTR_INTERNED
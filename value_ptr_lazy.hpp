@@ -0,0 +1,203 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_LAZY
+#define SMART_PTR_VALUE_PTR_LAZY
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <functional>	// std::function
+#include <mutex>		// std::mutex, std::lock_guard
+
+namespace smart_ptr {
+
+	// lazy_value_ptr synchronization policy; no locking, for single-threaded use
+	struct lazy_unsynchronized {
+
+		bool ready() const noexcept { return this->ready_; }
+		void set_ready( bool ready ) noexcept { this->ready_ = ready; }
+
+		// run f once; not marked ready if f throws
+		template <typename F>
+		void call_once( F&& f ) {
+			if ( !this->ready_ ) {
+				f();
+				this->ready_ = true;
+			}
+		}
+
+		// run f while excluding call_once
+		template <typename F>
+		void locked( F&& f ) const { f(); }
+
+	private:
+		bool ready_ = false;
+	};	// lazy_unsynchronized
+
+	// lazy_value_ptr synchronization policy; thread-safe once initialization via double-checked locking
+	struct lazy_synchronized {
+
+		lazy_synchronized() = default;
+		lazy_synchronized( const lazy_synchronized& ) = delete;
+		lazy_synchronized& operator=( const lazy_synchronized& ) = delete;
+
+		bool ready() const noexcept { return this->ready_.load( std::memory_order_acquire ); }
+		void set_ready( bool ready ) noexcept { this->ready_.store( ready, std::memory_order_release ); }
+
+		// run f once; not marked ready if f throws
+		template <typename F>
+		void call_once( F&& f ) {
+			if ( this->ready() )
+				return;
+			std::lock_guard<std::mutex> lock( this->mutex_ );
+			if ( !this->ready_.load( std::memory_order_relaxed ) ) {
+				f();
+				this->set_ready( true );
+			}
+		}
+
+		// run f while excluding call_once
+		template <typename F>
+		void locked( F&& f ) const {
+			std::lock_guard<std::mutex> lock( this->mutex_ );
+			f();
+		}
+
+	private:
+		std::atomic<bool> ready_{ false };
+		mutable std::mutex mutex_;
+	};	// lazy_synchronized
+
+	// value_ptr that stores a factory and builds the pointee on first access
+	//	copying an unmaterialized lazy_value_ptr copies only the factory; once materialized, copies use Copier as value_ptr does
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::default_copy<T>
+		, typename Sync = lazy_unsynchronized
+	>
+	class lazy_value_ptr {
+	public:
+		using value_ptr_type = value_ptr<T, Deleter, Copier>;
+		using factory_type = std::function<value_ptr_type()>;
+		using element_type = T;
+		using pointer = typename value_ptr_type::pointer;
+		using reference = typename value_ptr_type::reference;
+		using deleter_type = Deleter;
+		using copier_type = Copier;
+
+		// std::nullptr_t, default ctor; materialized and empty
+		lazy_value_ptr( std::nullptr_t = nullptr )
+		{
+			this->sync_.set_ready( true );
+		}
+
+		// construct materialized from value_ptr
+		lazy_value_ptr( value_ptr_type ptr )
+			: ptr_( std::move( ptr ) )
+		{
+			this->sync_.set_ready( true );
+		}
+
+		// construct with factory; factory result must be convertible to value_ptr_type
+		template <typename F, typename = decltype( value_ptr_type( std::declval<F&>()() ) )>
+		explicit lazy_value_ptr( F factory )
+			: factory_( [factory]() mutable { return value_ptr_type( factory() ); } )
+		{}
+
+		lazy_value_ptr( const lazy_value_ptr& that ) {
+			that.sync_.locked( [&]() {
+				if ( that.sync_.ready() )
+					this->ptr_ = that.ptr_;	// deep copy
+				else
+					this->factory_ = that.factory_;	// copy factory only
+				this->sync_.set_ready( that.sync_.ready() );
+			} );
+		}
+
+		lazy_value_ptr( lazy_value_ptr&& that ) {
+			that.sync_.locked( [&]() {
+				this->ptr_ = std::move( that.ptr_ );
+				this->factory_ = std::move( that.factory_ );
+				this->sync_.set_ready( that.sync_.ready() );
+				that.factory_ = nullptr;
+				that.sync_.set_ready( true );
+			} );
+		}
+
+		lazy_value_ptr& operator=( lazy_value_ptr that ) {
+			this->swap( that );
+			return *this;
+		}
+
+		// build pointee if not yet built; returns the materialized value_ptr
+		value_ptr_type& materialize() const {
+			this->sync_.call_once( [this]() {
+				this->ptr_ = this->factory_();
+				this->factory_ = nullptr;	// release captured state
+			} );
+			return this->ptr_;
+		}
+
+		// return flag if pointee has been built (or was supplied)
+		bool is_materialized() const noexcept { return this->sync_.ready(); }
+
+		// get pointer; materializes
+		pointer get() const { return this->materialize().get(); }
+
+		// return reference to T; materializes, UB if null
+		reference operator*() const { return *this->get(); }
+
+		// return pointer to T; materializes
+		pointer operator->() const { return this->get(); }
+
+		// return flag if has pointer; materializes
+		explicit operator bool() const { return (bool)this->materialize(); }
+
+		copier_type& get_copier() { return this->materialize().get_copier(); }
+		const copier_type& get_copier() const { return this->materialize().get_copier(); }
+
+		deleter_type& get_deleter() { return this->materialize().get_deleter(); }
+		const deleter_type& get_deleter() const { return this->materialize().get_deleter(); }
+
+		// reset to materialized and empty
+		void reset() {
+			this->ptr_.reset();
+			this->factory_ = nullptr;
+			this->sync_.set_ready( true );
+		}
+
+		// swap with other lazy_value_ptr; not synchronized
+		void swap( lazy_value_ptr& that ) {
+			this->ptr_.swap( that.ptr_ );
+			this->factory_.swap( that.factory_ );
+			const bool ready = this->sync_.ready();
+			this->sync_.set_ready( that.sync_.ready() );
+			that.sync_.set_ready( ready );
+		}
+
+	private:
+		mutable value_ptr_type ptr_;
+		mutable factory_type factory_;
+		mutable Sync sync_;
+	};	// lazy_value_ptr
+
+	// lazy_value_ptr with thread-safe once initialization
+	template <typename T, typename Deleter = std::default_delete<T>, typename Copier = detail::default_copy<T>>
+	using lazy_value_ptr_synchronized = lazy_value_ptr<T, Deleter, Copier, lazy_synchronized>;
+
+	// make lazy_value_ptr<T> which constructs T from copies of args on first access, analogous to make_value
+	template <typename T, typename... Args>
+	lazy_value_ptr<T> make_lazy_value( Args&&... args ) {
+		auto bound = std::bind( []( const typename std::decay<Args>::type&... a ) { return make_value<T>( a... ); }, std::forward<Args>( args )... );
+		return lazy_value_ptr<T>( std::move( bound ) );
+	}
+
+	template <class T, class D, class C, class S>
+	void swap( lazy_value_ptr<T, D, C, S>& x, lazy_value_ptr<T, D, C, S>& y ) { x.swap( y ); }
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_LAZY
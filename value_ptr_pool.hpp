@@ -0,0 +1,245 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_POOL
+#define SMART_PTR_VALUE_PTR_POOL
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <cstddef>		// std::size_t, std::max_align_t
+#include <new>			// operator new, placement new
+
+namespace smart_ptr {
+
+	// per-thread statistics for one pooled type
+	struct pool_stats {
+		std::size_t hits = 0;			// allocations served from the free list
+		std::size_t misses = 0;			// allocations that fell through to operator new
+		std::size_t local_frees = 0;	// frees performed by the owning thread
+		std::size_t remote_frees = 0;	// frees sent back to this pool by other threads
+		std::size_t cached = 0;			// slots currently held in the free list
+	};	// pool_stats
+
+	namespace detail {
+
+		struct pool_base;
+
+		// slot header, placed in front of each pooled object
+		struct pool_slot {
+			pool_base* owner;
+			pool_slot* next;
+		};
+
+		// object offset within a slot; keeps the object max-aligned
+		constexpr std::size_t pool_header_size = ( ( sizeof( pool_slot ) + alignof( std::max_align_t ) - 1 ) / alignof( std::max_align_t ) ) * alignof( std::max_align_t );
+
+		// unique per live thread; used to recognize the owning thread of a pool
+		inline const void* pool_thread_token() noexcept {
+			static thread_local char token;
+			return &token;
+		}
+
+		// free list of fixed-size slots for one type, owned by one thread
+		//	lifetime:  one reference held by the owning thread, one per live object; last release deletes
+		struct pool_base {
+
+			using clone_fn = void* (*)( const void* );	// copies a most-derived object into the calling thread's pool
+
+			const std::size_t slot_size;
+			const clone_fn clone;
+
+			pool_base( std::size_t slot_size_, clone_fn clone_ )
+				: slot_size( slot_size_ )
+				, clone( clone_ )
+				, owner_thread_( pool_thread_token() )
+			{}
+
+			pool_base( const pool_base& ) = delete;
+			pool_base& operator=( const pool_base& ) = delete;
+
+			// get a slot; owning thread only
+			pool_slot* acquire() {
+				if ( !this->free_ )
+					this->drain_remote();
+
+				pool_slot* slot = this->free_;
+				if ( slot ) {
+					this->free_ = slot->next;
+					--this->stats_.cached;
+					++this->stats_.hits;
+				}
+				else {
+					slot = static_cast<pool_slot*>( ::operator new( this->slot_size ) );
+					++this->stats_.misses;
+				}
+				slot->owner = this;
+				this->refs_.fetch_add( 1, std::memory_order_relaxed );
+				return slot;
+			}
+
+			// return a slot; any thread.  frees from other threads are pushed to the remote list for the owner to reclaim
+			void release( pool_slot* slot ) noexcept {
+				if ( this->owner_thread_.load( std::memory_order_relaxed ) == pool_thread_token() ) {
+					slot->next = this->free_;
+					this->free_ = slot;
+					++this->stats_.cached;
+					++this->stats_.local_frees;
+				}
+				else {
+					slot->next = this->remote_.load( std::memory_order_relaxed );
+					while ( !this->remote_.compare_exchange_weak( slot->next, slot, std::memory_order_release, std::memory_order_relaxed ) )
+						;
+					this->remote_frees_.fetch_add( 1, std::memory_order_relaxed );
+				}
+				this->release_ref();
+			}
+
+			// owning thread exited; free cached slots, drop the thread's reference
+			void detach_thread() noexcept {
+				this->owner_thread_.store( nullptr, std::memory_order_relaxed );
+				free_list( this->free_ );
+				this->free_ = nullptr;
+				this->stats_.cached = 0;
+				this->release_ref();
+			}
+
+			pool_stats stats() const noexcept {
+				pool_stats result = this->stats_;
+				result.remote_frees = this->remote_frees_.load( std::memory_order_relaxed );
+				return result;
+			}
+
+		private:
+			std::atomic<const void*> owner_thread_;
+			std::atomic<std::size_t> refs_{ 1 };
+			std::atomic<pool_slot*> remote_{ nullptr };
+			std::atomic<std::size_t> remote_frees_{ 0 };
+			pool_slot* free_ = nullptr;
+			pool_stats stats_;
+
+			~pool_base() {
+				free_list( this->free_ );
+				free_list( this->remote_.load( std::memory_order_acquire ) );
+			}
+
+			void release_ref() noexcept {
+				if ( this->refs_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+					delete this;
+			}
+
+			// move slots freed by other threads onto the local free list
+			void drain_remote() noexcept {
+				pool_slot* slot = this->remote_.exchange( nullptr, std::memory_order_acquire );
+				while ( slot ) {
+					pool_slot* next = slot->next;
+					slot->next = this->free_;
+					this->free_ = slot;
+					++this->stats_.cached;
+					slot = next;
+				}
+			}
+
+			static void free_list( pool_slot* slot ) noexcept {
+				while ( slot ) {
+					pool_slot* next = slot->next;
+					::operator delete( slot );
+					slot = next;
+				}
+			}
+		};	// pool_base
+
+		inline void* pool_object( pool_slot* slot ) noexcept { return reinterpret_cast<char*>( slot ) + pool_header_size; }
+		inline pool_slot* pool_slot_of( const void* object ) noexcept { return reinterpret_cast<pool_slot*>( const_cast<char*>( static_cast<const char*>( object ) ) - pool_header_size ); }
+
+		// address of the most-derived object; pool slots are keyed by dynamic type
+		template <typename T>
+		const void* pool_most_derived( const T* ptr, std::true_type /*polymorphic*/ ) noexcept { return dynamic_cast<const void*>( ptr ); }
+
+		template <typename T>
+		const void* pool_most_derived( const T* ptr, std::false_type ) noexcept { return ptr; }
+
+		template <typename T>
+		const void* pool_most_derived( const T* ptr ) noexcept { return pool_most_derived( ptr, std::is_polymorphic<T>() ); }
+
+	}	// detail
+
+	// thread-local pool of fixed-size slots for objects of dynamic type U
+	template <typename U>
+	struct value_pool {
+
+		static_assert( alignof( U ) <= alignof( std::max_align_t ), "value_pool; over-aligned types are not supported" );
+
+		// construct a U in a slot from the calling thread's pool
+		template <typename... Args>
+		static U* construct( Args&&... args ) {
+			detail::pool_base& pool = local();
+			detail::pool_slot* slot = pool.acquire();
+			try {
+				return ::new( detail::pool_object( slot ) ) U( std::forward<Args>( args )... );
+			}
+			catch ( ... ) {
+				pool.release( slot );
+				throw;
+			}
+		}
+
+		// statistics for the calling thread's pool
+		static pool_stats stats() { return local().stats(); }
+
+	private:
+		struct holder {
+			detail::pool_base* pool = new detail::pool_base( detail::pool_header_size + sizeof( U ), &value_pool::clone );
+			~holder() { this->pool->detach_thread(); }
+		};
+
+		static detail::pool_base& local() {
+			static thread_local holder h;
+			return *h.pool;
+		}
+
+		static void* clone( const void* what ) { return construct( *static_cast<const U*>( what ) ); }
+	};	// value_pool
+
+	// stateless deleter; destroys the pointee and returns its slot to the owning thread's pool
+	template <typename T>
+	struct pool_deleter {
+		void operator()( T* ptr ) const noexcept {
+			detail::pool_slot* slot = detail::pool_slot_of( detail::pool_most_derived( ptr ) );
+			ptr->~T();
+			slot->owner->release( slot );
+		}
+	};	// pool_deleter
+
+	// stateless copier; copies the pointee's dynamic type into a slot from the calling thread's pool
+	template <typename T>
+	struct pool_copier {
+		T* operator()( const T* what ) const {
+			if ( !what )
+				return nullptr;
+			const void* most_derived = detail::pool_most_derived( what );
+			void* result = detail::pool_slot_of( most_derived )->owner->clone( most_derived );
+
+			// same dynamic type, so the T subobject sits at the same offset in the copy
+			const auto offset = reinterpret_cast<const char*>( what ) - static_cast<const char*>( most_derived );
+			return reinterpret_cast<T*>( static_cast<char*>( result ) + offset );
+		}
+	};	// pool_copier
+
+	// value_ptr allocating from thread-local pools; sizeof == sizeof(T*)
+	//	pointees must be created with make_value_pooled; reset(new T) or deleting a released pointer is undefined
+	template <typename T>
+	using value_ptr_pooled = value_ptr<T, pool_deleter<T>, pool_copier<T>>;
+
+	// make value_ptr_pooled<T> holding a U from the calling thread's pool, analogous to make_value
+	template <typename T, typename U = T, typename... Args>
+	value_ptr_pooled<T> make_value_pooled( Args&&... args ) {
+		static_assert( std::is_same<T, U>::value || std::has_virtual_destructor<T>::value, "make_value_pooled; T must have a virtual destructor when U is derived" );
+		return value_ptr_pooled<T>( static_cast<T*>( value_pool<U>::construct( std::forward<Args>( args )... ) ) );
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_POOL
@@ -0,0 +1,180 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_SHARED_POLICY
+#define SMART_PTR_VALUE_PTR_SHARED_POLICY
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <cstddef>		// std::size_t, std::max_align_t
+#include <new>			// placement new
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// refcounted, allocator-erased control block shared by every pointee created through one shared_policy
+		struct policy_block {
+
+			policy_block() = default;
+			policy_block( const policy_block& ) = delete;
+			policy_block& operator=( const policy_block& ) = delete;
+
+			virtual void* allocate( std::size_t units ) = 0;
+			virtual void deallocate( void* ptr, std::size_t units ) noexcept = 0;
+
+			void add_ref() noexcept { this->refs_.fetch_add( 1, std::memory_order_relaxed ); }
+
+			void release() noexcept {
+				if ( this->refs_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+					delete this;
+			}
+
+			std::size_t use_count() const noexcept { return this->refs_.load( std::memory_order_relaxed ); }
+
+		protected:
+			virtual ~policy_block() = default;
+
+		private:
+			std::atomic<std::size_t> refs_{ 1 };
+		};	// policy_block
+
+		// control block holding a (possibly stateful) allocator, rebound to max-aligned units
+		template <typename Alloc>
+		struct policy_block_impl : policy_block {
+
+			using unit_type = std::max_align_t;
+			using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<unit_type>;
+			using traits = std::allocator_traits<allocator_type>;
+
+			allocator_type alloc;
+
+			explicit policy_block_impl( const Alloc& alloc_ )
+				: alloc( alloc_ )
+			{}
+
+			void* allocate( std::size_t units ) override { return traits::allocate( this->alloc, units ); }
+			void deallocate( void* ptr, std::size_t units ) noexcept override { traits::deallocate( this->alloc, static_cast<unit_type*>( ptr ), units ); }
+		};	// policy_block_impl
+
+		// header placed in front of each pointee; locates the shared control block from a bare T*
+		struct policy_header {
+			policy_block* block;
+		};
+
+		// storage layout:  [ policy_header | padding | T ], allocated as a single block
+		template <typename T>
+		struct policy_layout {
+
+			static_assert( alignof( T ) <= alignof( std::max_align_t ), "value_ptr_shared_policy; over-aligned types are not supported" );
+			static_assert( !std::is_polymorphic<T>::value, "value_ptr_shared_policy; polymorphic types would be sliced on copy" );
+
+			static constexpr std::size_t offset = ( ( sizeof( policy_header ) + alignof( T ) - 1 ) / alignof( T ) ) * alignof( T );
+			static constexpr std::size_t units = ( offset + sizeof( T ) + sizeof( std::max_align_t ) - 1 ) / sizeof( std::max_align_t );
+
+			static policy_header* header_of( const T* ptr ) noexcept {
+				return reinterpret_cast<policy_header*>( reinterpret_cast<char*>( const_cast<T*>( ptr ) ) - offset );
+			}
+
+			// allocate through block, construct T, take a reference on block
+			template <typename... Args>
+			static T* construct( policy_block* block, Args&&... args ) {
+				void* storage = block->allocate( units );
+				T* result = nullptr;
+				try {
+					result = ::new( static_cast<void*>( static_cast<char*>( storage ) + offset ) ) T( std::forward<Args>( args )... );
+				}
+				catch ( ... ) {
+					block->deallocate( storage, units );
+					throw;
+				}
+				::new( storage ) policy_header{ block };
+				block->add_ref();
+				return result;
+			}
+
+			// destroy T, return storage to block, drop reference on block
+			static void destroy( T* ptr ) noexcept {
+				policy_header* header = header_of( ptr );
+				policy_block* block = header->block;
+				ptr->~T();
+				block->deallocate( header, units );
+				block->release();
+			}
+		};	// policy_layout
+
+	}	// detail
+
+	// refcounted handle to a stateful allocation policy shared by many value_ptr_shared_policy instances
+	//	scope:  the shared state is an allocator; telemetry or pooling state belongs in the allocator, which sees every allocation and release
+	//	arbitrary Deleter/Copier objects are not held:  they allocate their pointees themselves, leaving no header to locate the control block
+	class shared_policy {
+	public:
+		// construct with std::allocator
+		shared_policy()
+			: shared_policy( std::allocator<std::max_align_t>() )
+		{}
+
+		// construct with (possibly stateful) allocator; the allocator is copied once into the control block
+		template <typename Alloc>
+		explicit shared_policy( const Alloc& alloc )
+			: block_( new detail::policy_block_impl<Alloc>( alloc ) )
+		{}
+
+		shared_policy( const shared_policy& that ) noexcept
+			: block_( that.block_ )
+		{
+			this->block_->add_ref();
+		}
+
+		shared_policy& operator=( const shared_policy& that ) noexcept {
+			that.block_->add_ref();
+			this->block_->release();
+			this->block_ = that.block_;
+			return *this;
+		}
+
+		~shared_policy() { this->block_->release(); }
+
+		// number of policy handles and live pointees referencing the control block
+		std::size_t use_count() const noexcept { return this->block_->use_count(); }
+
+		detail::policy_block* block() const noexcept { return this->block_; }
+
+	private:
+		detail::policy_block* block_;
+	};	// shared_policy
+
+	// stateless deleter; destroys the pointee and releases it through the control block found in its header
+	template <typename T>
+	struct shared_policy_deleter {
+		void operator()( T* ptr ) const noexcept { detail::policy_layout<T>::destroy( ptr ); }
+	};	// shared_policy_deleter
+
+	// stateless copier; copies the pointee through the control block found in its header
+	template <typename T>
+	struct shared_policy_copier {
+		T* operator()( const T* what ) const {
+			if ( !what )
+				return nullptr;
+			return detail::policy_layout<T>::construct( detail::policy_layout<T>::header_of( what )->block, *what );
+		}
+	};	// shared_policy_copier
+
+	// value_ptr whose deleter/copier state lives in a shared control block; sizeof == sizeof(T*)
+	//	pointees must be created with make_value_shared; reset(new T) or deleting a released pointer is undefined
+	template <typename T>
+	using value_ptr_shared_policy = value_ptr<T, shared_policy_deleter<T>, shared_policy_copier<T>>;
+
+	// make value_ptr_shared_policy, allocating through policy
+	template <typename T, typename... Args>
+	value_ptr_shared_policy<T> make_value_shared( const shared_policy& policy, Args&&... args ) {
+		return value_ptr_shared_policy<T>( detail::policy_layout<T>::construct( policy.block(), std::forward<Args>( args )... ) );
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_SHARED_POLICY
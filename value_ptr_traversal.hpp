@@ -0,0 +1,213 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_TRAVERSAL
+#define SMART_PTR_VALUE_PTR_TRAVERSAL
+
+#include "value_ptr.hpp"
+
+#include <cstddef>		// std::size_t, std::ptrdiff_t
+#include <iterator>		// std::begin, std::end, std::iterator_traits
+#include <typeinfo>		// typeid
+#include <vector>		// std::vector
+
+#if defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+#include <xmmintrin.h>	// _mm_prefetch
+#endif
+
+namespace smart_ptr {
+
+	// prefetch distance used by prefetched(), in elements
+	constexpr std::size_t default_prefetch_distance = 16;
+
+	namespace detail {
+
+		// hint that the cache line at ptr will be read soon; never faults, null is fine
+		inline void prefetch( const void* ptr ) noexcept {
+#if defined( __GNUC__ ) || defined( __clang__ )
+			__builtin_prefetch( ptr, 0 /*read*/, 3 /*keep in all cache levels*/ );
+#elif defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+			_mm_prefetch( static_cast<const char*>( ptr ), _MM_HINT_T0 );
+#else
+			(void)ptr;
+#endif
+		}
+
+		// pointee address of a value_ptr, unique_ptr or raw pointer element
+		template <typename P>
+		auto pointee_address( const P& p ) noexcept -> decltype( p.get() ) { return p.get(); }
+
+		template <typename T>
+		T* pointee_address( T* p ) noexcept { return p; }
+
+		template <typename Iterator>
+		using range_pointer = decltype( pointee_address( *std::declval<Iterator&>() ) );
+
+		// element's deleter records a dynamic type tag, e.g. value_ptr_tagged
+		template <class P, class = void> struct has_element_type_tag : std::false_type {};
+		template <class P> struct has_element_type_tag<P, decltype( void( std::declval<const P&>().get_deleter().type_tag() ) )> : std::true_type {};
+
+		// key grouping pointees by dynamic type; typeid for polymorphic types, one group otherwise
+		template <typename T>
+		const void* typeid_key( const T* ptr, std::true_type /*polymorphic*/ ) noexcept { return &typeid( *ptr ); }
+
+		template <typename T>
+		const void* typeid_key( const T*, std::false_type ) noexcept { return nullptr; }
+
+		template <typename P>
+		const void* dynamic_type_key( const P& p, std::false_type ) noexcept {
+			const auto ptr = pointee_address( p );
+			return typeid_key( ptr, std::is_polymorphic<typename std::remove_pointer<decltype( ptr )>::type>() );
+		}
+
+		// tagged elements are grouped without touching the pointee
+		template <typename P>
+		const void* dynamic_type_key( const P& p, std::true_type /*tagged*/ ) noexcept {
+			const void* tag = p.get_deleter().type_tag();
+			return tag ? tag : dynamic_type_key( p, std::false_type() );
+		}
+
+	}	// detail
+
+	// forward iterator over a range of pointers, prefetching the pointee a fixed distance ahead
+	template <typename Iterator>
+	class prefetch_iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename std::iterator_traits<Iterator>::value_type;
+		using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+		using pointer = typename std::iterator_traits<Iterator>::pointer;
+		using reference = typename std::iterator_traits<Iterator>::reference;
+
+		prefetch_iterator() = default;
+
+		prefetch_iterator( Iterator it, Iterator lead, Iterator last )
+			: it_( it )
+			, lead_( lead )
+			, last_( last )
+		{}
+
+		reference operator*() const { return *this->it_; }
+		Iterator operator->() const { return this->it_; }
+
+		prefetch_iterator& operator++() {
+			if ( this->lead_ != this->last_ ) {
+				detail::prefetch( detail::pointee_address( *this->lead_ ) );
+				++this->lead_;
+			}
+			++this->it_;
+			return *this;
+		}
+
+		prefetch_iterator operator++( int ) {
+			prefetch_iterator result( *this );
+			++*this;
+			return result;
+		}
+
+		// underlying iterator
+		Iterator base() const { return this->it_; }
+
+		friend bool operator == ( const prefetch_iterator& x, const prefetch_iterator& y ) { return x.it_ == y.it_; }
+		friend bool operator != ( const prefetch_iterator& x, const prefetch_iterator& y ) { return x.it_ != y.it_; }
+
+	private:
+		Iterator it_{};
+		Iterator lead_{};	// next element to prefetch
+		Iterator last_{};
+	};	// prefetch_iterator
+
+	// range adaptor returned by prefetched()
+	template <typename Iterator>
+	class prefetch_range {
+	public:
+		using iterator = prefetch_iterator<Iterator>;
+
+		prefetch_range( Iterator first, Iterator last, std::size_t distance )
+			: first_( first )
+			, last_( last )
+			, distance_( distance )
+		{}
+
+		// prefetches the first distance pointees
+		iterator begin() const {
+			Iterator lead = this->first_;
+			for ( std::size_t i = 0; i < this->distance_ && lead != this->last_; ++i, ++lead )
+				detail::prefetch( detail::pointee_address( *lead ) );
+			return iterator( this->first_, lead, this->last_ );
+		}
+
+		iterator end() const { return iterator( this->last_, this->last_, this->last_ ); }
+
+	private:
+		Iterator first_;
+		Iterator last_;
+		std::size_t distance_;
+	};	// prefetch_range
+
+	// adapt a range of value_ptr (or unique_ptr, raw pointers) so that iterating it prefetches pointees distance elements ahead
+	//	e.g.  for ( auto& p : prefetched( shapes ) ) p->draw();
+	template <typename Range>
+	auto prefetched( Range& range, std::size_t distance = default_prefetch_distance ) -> prefetch_range<decltype( std::begin( range ) )> {
+		return prefetch_range<decltype( std::begin( range ) )>( std::begin( range ), std::end( range ), distance );
+	}
+
+	// pointees of a range of value_ptr (or unique_ptr, raw pointers) grouped by dynamic type, in order of each type's first appearance
+	//	order within a type is kept; null elements are skipped
+	//	grouping uses the deleter's type tag where available (value_ptr_tagged), typeid otherwise
+	//	visiting the result runs virtual calls in homogeneous batches, keeping indirect branches predictable
+	template <typename Range>
+	auto by_dynamic_type( Range& range, std::size_t distance = default_prefetch_distance ) -> std::vector<detail::range_pointer<decltype( std::begin( range ) )>> {
+		using element_type = typename std::decay<decltype( *std::begin( range ) )>::type;
+		using result_pointer = detail::range_pointer<decltype( std::begin( range ) )>;
+
+		std::vector<result_pointer> pointees;
+		std::vector<std::size_t> bucket_of;
+		std::vector<const void*> keys;
+		std::vector<std::size_t> counts;
+		std::size_t last = 0;	// bucket of the previous element; runs of one type are common
+
+		for ( auto& element : prefetched( range, distance ) ) {
+			const auto ptr = detail::pointee_address( element );
+			if ( !ptr )
+				continue;
+			const void* key = detail::dynamic_type_key( element, detail::has_element_type_tag<element_type>() );
+			if ( keys.empty() || keys[last] != key ) {
+				last = 0;
+				while ( last < keys.size() && keys[last] != key )
+					++last;
+				if ( last == keys.size() ) {
+					keys.push_back( key );
+					counts.push_back( 0 );
+				}
+			}
+			++counts[last];
+			pointees.push_back( ptr );
+			bucket_of.push_back( last );
+		}
+
+		// stable counting sort by bucket
+		std::size_t offset = 0;
+		for ( auto& count : counts ) {
+			const std::size_t n = count;
+			count = offset;
+			offset += n;
+		}
+		std::vector<result_pointer> result( pointees.size() );
+		for ( std::size_t i = 0; i < pointees.size(); ++i )
+			result[counts[bucket_of[i]]++] = pointees[i];
+		return result;
+	}
+
+	// call f with a reference to each non-null pointee, grouped by dynamic type as by_dynamic_type
+	template <typename Range, typename F>
+	void for_each_by_dynamic_type( Range& range, F&& f ) {
+		for ( auto ptr : by_dynamic_type( range ) )
+			f( *ptr );
+	}
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_TRAVERSAL
@@ -0,0 +1,227 @@
+// Copyright 2017-2018 by Tom Clunie
+// https://github.com/clunietp/value_ptr
+// Distributed under the Boost Software License, Version 1.0.
+//    (See http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SMART_PTR_VALUE_PTR_VERSIONED
+#define SMART_PTR_VALUE_PTR_VERSIONED
+
+#include "value_ptr.hpp"
+
+#include <atomic>		// std::atomic
+#include <cstddef>		// std::size_t
+#include <deque>		// std::deque
+
+namespace smart_ptr {
+
+	namespace detail {
+
+		// shared, refcounted holder of one version of a pointee
+		template <typename T, typename Deleter, typename Copier>
+		struct versioned_node {
+			std::atomic<std::size_t> refs{ 1 };
+			value_ptr<T, Deleter, Copier> value;
+
+			explicit versioned_node( value_ptr<T, Deleter, Copier>&& value_ )
+				: value( std::move( value_ ) )
+			{}
+		};	// versioned_node
+
+	}	// detail
+
+	// copy-on-write value_ptr for persistent, versioned state
+	//	copies share the pointee and cost O(1); write() copies the pointee through Copier only while it is shared
+	//	state built from nested versioned_ptr members is path copied:  writing a leaf copies the nodes from the root to that leaf, siblings stay shared
+	//	reads are const; the pointee is immutable while shared, so versions may be read from several threads
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::default_copy<T>
+	>
+	class versioned_ptr {
+		using node_type = detail::versioned_node<T, Deleter, Copier>;
+	public:
+		using value_ptr_type = value_ptr<T, Deleter, Copier>;
+		using element_type = T;
+		using const_pointer = const T*;
+
+		// std::nullptr_t, default ctor
+		versioned_ptr( std::nullptr_t = nullptr ) noexcept {}
+
+		// take ownership of value_ptr's pointee, with its deleter and copier
+		explicit versioned_ptr( value_ptr_type ptr )
+			: node_( ptr ? new node_type( std::move( ptr ) ) : nullptr )
+		{}
+
+		// take ownership of px
+		template <typename Px, typename = typename std::enable_if<std::is_convertible<Px, T*>::value>::type>
+		explicit versioned_ptr( Px px, Deleter dx = {}, Copier cx = {} )
+			: versioned_ptr( value_ptr_type( px, std::move( dx ), std::move( cx ) ) )
+		{}
+
+		// share that's pointee
+		versioned_ptr( const versioned_ptr& that ) noexcept
+			: node_( that.node_ )
+		{
+			if ( this->node_ )
+				this->node_->refs.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		versioned_ptr( versioned_ptr&& that ) noexcept
+			: node_( that.node_ )
+		{
+			that.node_ = nullptr;
+		}
+
+		versioned_ptr& operator=( versioned_ptr that ) noexcept {
+			this->swap( that );
+			return *this;
+		}
+
+		~versioned_ptr() { this->release(); }
+
+		// get pointer; read only, the pointee may be shared with other versions
+		const_pointer get() const noexcept { return this->node_ ? this->node_->value.get() : nullptr; }
+
+		// return reference to T, UB if null
+		const T& operator*() const noexcept { return *this->get(); }
+
+		// return pointer to T
+		const_pointer operator->() const noexcept { return this->get(); }
+
+		// return flag if has pointer
+		explicit operator bool() const noexcept { return this->node_ != nullptr; }
+
+		// return mutable reference to T, copying the pointee first if it is shared; UB if null
+		T& write() {
+			assert( this->node_ && "versioned_ptr; write to null" );
+			if ( !this->unique() ) {
+				node_type* copy = new node_type( value_ptr_type( this->node_->value ) );	// deep copy through Copier; nested versioned_ptr members are shared
+				this->release();
+				this->node_ = copy;
+			}
+			return *this->node_->value;
+		}
+
+		// return flag if no other version shares the pointee
+		bool unique() const noexcept { return this->node_ && this->node_->refs.load( std::memory_order_acquire ) == 1; }
+
+		// number of versions sharing the pointee, 0 if null
+		std::size_t use_count() const noexcept { return this->node_ ? this->node_->refs.load( std::memory_order_relaxed ) : 0; }
+
+		// return flag if that shares this pointee
+		bool shares( const versioned_ptr& that ) const noexcept { return this->node_ == that.node_; }
+
+		// return deep copy as value_ptr
+		value_ptr_type to_value_ptr() const { return this->node_ ? this->node_->value : value_ptr_type(); }
+
+		void reset() noexcept {
+			this->release();
+			this->node_ = nullptr;
+		}
+
+		void swap( versioned_ptr& that ) noexcept { std::swap( this->node_, that.node_ ); }
+
+	private:
+		node_type* node_ = nullptr;
+
+		void release() noexcept {
+			if ( this->node_ && this->node_->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+				delete this->node_;
+		}
+	};	// versioned_ptr
+
+	template <class T, class D, class C> void swap( versioned_ptr<T, D, C>& x, versioned_ptr<T, D, C>& y ) noexcept { x.swap( y ); }
+
+	// make versioned_ptr<T>, analogous to make_value
+	template <typename T, typename... Args>
+	versioned_ptr<T> make_versioned( Args&&... args ) {
+		return versioned_ptr<T>( make_value<T>( std::forward<Args>( args )... ) );
+	}
+
+	// undo/checkpoint history of versioned_ptr state
+	//	commit() and rollback() are O(1); each retained version holds only the nodes it does not share with others
+	//	dropping a version releases its nodes, reclaiming those no other version or the current state uses
+	template <typename T
+		, typename Deleter = std::default_delete<T>
+		, typename Copier = detail::default_copy<T>
+	>
+	class version_history {
+	public:
+		using pointer_type = versioned_ptr<T, Deleter, Copier>;
+		using version = std::size_t;
+
+		explicit version_history( pointer_type initial = nullptr )
+			: current_( std::move( initial ) )
+		{}
+
+		// working state; edit through current().write()
+		pointer_type& current() noexcept { return this->current_; }
+		const pointer_type& current() const noexcept { return this->current_; }
+
+		// record the working state as a new version
+		version commit() {
+			this->versions_.push_back( entry{ this->current_, true } );
+			return this->first_ + this->versions_.size() - 1;
+		}
+
+		// return flag if v is committed and not dropped
+		bool contains( version v ) const noexcept { return v >= this->first_ && v - this->first_ < this->versions_.size() && this->versions_[v - this->first_].retained; }
+
+		// state recorded as version v
+		const pointer_type& at( version v ) const {
+			assert( this->contains( v ) && "version_history; version dropped or not committed" );
+			return this->versions_[v - this->first_].state;
+		}
+
+		// make version v the working state; later versions are kept
+		void rollback( version v ) { this->current_ = this->at( v ); }
+
+		// release version v
+		void drop( version v ) {
+			if ( !this->contains( v ) )
+				return;
+			entry& e = this->versions_[v - this->first_];
+			e.state.reset();
+			e.retained = false;
+			this->trim();
+		}
+
+		// release all versions before v
+		void drop_before( version v ) {
+			while ( this->first_ < v && !this->versions_.empty() ) {
+				this->versions_.pop_front();
+				++this->first_;
+			}
+			this->trim();
+		}
+
+		// number of retained versions
+		std::size_t size() const noexcept {
+			std::size_t n = 0;
+			for ( const entry& e : this->versions_ )
+				n += e.retained ? 1 : 0;
+			return n;
+		}
+
+	private:
+		struct entry {
+			pointer_type state;
+			bool retained;
+		};
+
+		// pop dropped versions from the front, so ids stay stable while storage shrinks
+		void trim() {
+			while ( !this->versions_.empty() && !this->versions_.front().retained ) {
+				this->versions_.pop_front();
+				++this->first_;
+			}
+		}
+
+		pointer_type current_;
+		std::deque<entry> versions_;
+		version first_ = 0;	// id of versions_.front()
+	};	// version_history
+
+}	// smart_ptr ns
+
+#endif // !SMART_PTR_VALUE_PTR_VERSIONED